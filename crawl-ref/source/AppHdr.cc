@@ -9,7 +9,6 @@
 #ifdef TARGET_COMPILER_VC
     #pragma comment (lib, "pcre.lib")
     #pragma comment (lib, "lua.lib")
-    #pragma comment (lib, "sqlite.lib")
         #ifdef USE_TILE_LOCAL
             #pragma comment (lib, "freetype.lib")
             #pragma comment (lib, "SDL.lib")
@@ -228,6 +228,11 @@ static inline double pow(int x, double y) { return std::pow((double)x, y); }
     //
     #define DGL_CLEAR_SCREEN "\033[2J"
 
+    // Send DGL_CLEAR_SCREEN at most this often, in seconds. Other screen
+    // clears only repaint what changed, which keeps ttyrecs small; the
+    // cost is that ttyplay may have to replay this much to catch up.
+    #define DGL_CLEAR_INTERVAL 5
+
     // Create .des and database cache files in a directory named with the
     // game version so that multiple save-compatible Crawl versions can
     // share the same savedir.
@@ -400,10 +405,6 @@ static inline double pow(int x, double y) { return std::pow((double)x, y); }
 // these -- usually this means you should place them in ~/.crawl/
 // unless it's a DGL build.
 
-#if !defined(DB_NDBM) && !defined(DB_DBH) && !defined(USE_SQLITE_DBM)
-#define USE_SQLITE_DBM
-#endif
-
 // Uncomment these if you can't find these functions on your system
 // #define NEED_USLEEP
 
@@ -2,9 +2,21 @@
 
 #include "act-iter.h"
 
+#include <algorithm>
+
 #include "env.h"
 #include "losglobal.h"
 
+// The first slot after i that might hold a monster, or MAX_MONSTERS.
+// This looks the slot up afresh each time rather than keeping a position
+// in env.mons_used, so monsters may come and go while iterating.
+static int _next_used_slot(int i)
+{
+    const vector<int> &used = env.mons_used;
+    auto next = upper_bound(used.begin(), used.end(), i);
+    return next == used.end() ? MAX_MONSTERS : *next;
+}
+
 actor_near_iterator::actor_near_iterator(coord_def c, los_type los)
     : center(c), _los(los), viewer(nullptr), i(-1)
 {
@@ -64,7 +76,7 @@ bool actor_near_iterator::valid(const actor* a) const
 void actor_near_iterator::advance()
 {
     do
-         if (++i >= MAX_MONSTERS)
+         if ((i = _next_used_slot(i)) >= MAX_MONSTERS)
              return;
     while (!valid(**this));
 }
@@ -72,17 +84,15 @@ void actor_near_iterator::advance()
 //////////////////////////////////////////////////////////////////////////
 
 monster_near_iterator::monster_near_iterator(coord_def c, los_type los)
-    : center(c), _los(los), viewer(nullptr), i(0)
+    : center(c), _los(los), viewer(nullptr), i(-1)
 {
-    if (!valid(&menv[0]))
-        advance();
+    advance();
 }
 
 monster_near_iterator::monster_near_iterator(const actor *a, los_type los)
-    : center(a->pos()), _los(los), viewer(a), i(0)
+    : center(a->pos()), _los(los), viewer(a), i(-1)
 {
-    if (!valid(&menv[0]))
-        advance();
+    advance();
 }
 
 monster_near_iterator::operator bool() const
@@ -128,7 +138,7 @@ bool monster_near_iterator::valid(const monster* a) const
 void monster_near_iterator::advance()
 {
     do
-         if (++i >= MAX_MONSTERS)
+         if ((i = _next_used_slot(i)) >= MAX_MONSTERS)
              return;
     while (!valid(**this));
 }
@@ -136,10 +146,9 @@ void monster_near_iterator::advance()
 //////////////////////////////////////////////////////////////////////////
 
 monster_iterator::monster_iterator()
-    : i(0)
+    : i(-1)
 {
-    while (i < MAX_MONSTERS && !menv[i].alive())
-        i++;
+    advance();
 }
 
 monster_iterator::operator bool() const
@@ -162,9 +171,7 @@ monster* monster_iterator::operator->() const
 
 monster_iterator& monster_iterator::operator++()
 {
-    while (++i < MAX_MONSTERS)
-        if (menv[i].alive())
-            break;
+    advance();
     return *this;
 }
 
@@ -178,7 +185,7 @@ monster_iterator monster_iterator::operator++(int)
 void monster_iterator::advance()
 {
     do
-         if (++i >= MAX_MONSTERS)
+         if ((i = _next_used_slot(i)) >= MAX_MONSTERS)
              return;
     while (!(*this)->alive());
 }
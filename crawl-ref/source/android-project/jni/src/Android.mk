@@ -8,7 +8,6 @@ SDL_PATH := ../SDL2
 CRAWL_PATH := ../../..
 
 LOCAL_C_INCLUDES := $(LOCAL_PATH)/$(SDL_PATH)/include \
-                    $(LOCAL_PATH)/../sqlite \
                     $(LOCAL_PATH)/../lua/src \
                     $(LOCAL_PATH)/../freetype/include \
                     $(LOCAL_PATH)/$(CRAWL_PATH) \
@@ -69,6 +68,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/dgn-layouts.cc \
     $(CRAWL_PATH)/dgn-overview.cc \
     $(CRAWL_PATH)/dgn-proclayouts.cc \
+    $(CRAWL_PATH)/dgn-profile.cc \
     $(CRAWL_PATH)/dgn-shoals.cc \
     $(CRAWL_PATH)/dgn-swamp.cc \
     $(CRAWL_PATH)/dgnevent.cc \
@@ -87,6 +87,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/fight.cc \
     $(CRAWL_PATH)/files.cc \
     $(CRAWL_PATH)/fineff.cc \
+    $(CRAWL_PATH)/flatdb.cc \
     $(CRAWL_PATH)/food.cc \
     $(CRAWL_PATH)/format.cc \
     $(CRAWL_PATH)/fprop.cc \
@@ -238,7 +239,6 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/spl-wpnench.cc \
     $(CRAWL_PATH)/spl-zap.cc \
     $(CRAWL_PATH)/sprint.cc \
-    $(CRAWL_PATH)/sqldbm.cc \
     $(CRAWL_PATH)/stairs.cc \
     $(CRAWL_PATH)/startup.cc \
     $(CRAWL_PATH)/stash.cc \
@@ -322,7 +322,7 @@ LOCAL_SRC_FILES := $(SDL_PATH)/src/main/android/SDL_android_main.c \
     $(CRAWL_PATH)/rltiles/tiledef-unrand.cc \
     $(CRAWL_PATH)/version.cc
 
-LOCAL_SHARED_LIBRARIES := SDL2 SDL2_image mikmod smpeg2 SDL2_mixer freetype sqlite lua zlib
+LOCAL_SHARED_LIBRARIES := SDL2 SDL2_image mikmod smpeg2 SDL2_mixer freetype lua zlib
 
 LOCAL_LDLIBS := -ldl -lGLESv1_CM -lGLESv2 -llog -landroid
 
@@ -54,7 +54,6 @@ public class SDLActivity extends Activity {
         System.loadLibrary("SDL2_mixer");
         //System.loadLibrary("SDL2_net");
         //System.loadLibrary("SDL2_ttf");
-        System.loadLibrary("sqlite");
         System.loadLibrary("lua");
         System.loadLibrary("zlib");
         System.loadLibrary("main");
@@ -45,28 +45,70 @@ enum areaprop_flag
 };
 DEF_BITFIELD(areaprops, areaprop_flag);
 
+#define NUM_APROPS 12
+
 struct area_centre
 {
     area_centre_type type;
     coord_def centre;
     int radius;
+    // The actor whose area this is, or MID_NOBODY.
+    mid_t owner;
+
+    explicit area_centre (area_centre_type t, coord_def c, int r,
+                          mid_t o = MID_NOBODY)
+        : type(t), centre(c), radius(r), owner(o) { }
+};
+
+// Everything one actor contributes to the area grid: its centres, and each
+// cell and flag it sets. Keeping these around lets us take an actor's areas
+// back out when it moves or dies, instead of rebuilding the whole grid.
+struct area_footprint
+{
+    vector<area_centre> centres;
+    vector<pair<coord_def, areaprop_flag>> cells;
 
-    explicit area_centre (area_centre_type t, coord_def c, int r) : type(t), centre(c), radius(r) { }
+    void add(const coord_def& p, areaprop_flag f)
+    {
+        cells.emplace_back(p, f);
+    }
 };
 
 typedef FixedArray<areaprops, GXM, GYM> propgrid_t;
 
 static vector<area_centre> _agrid_centres;
+static map<mid_t, area_footprint> _agrid_footprints;
 
 static propgrid_t _agrid;
+// How many sources set each flag on each cell; a flag is cleared from
+// _agrid when its count drops to zero.
+static FixedArray<FixedVector<uint16_t, NUM_APROPS>, GXM, GYM> _agrid_count;
 static bool _agrid_valid = false;
 static bool no_areas = false;
 
+static int _aprop_index(areaprop_flag f)
+{
+    int i = 0;
+    while (!(f & (1 << i)))
+        ++i;
+    ASSERT(i < NUM_APROPS);
+    return i;
+}
+
 static void _set_agrid_flag(const coord_def& p, areaprop_flag f)
 {
+    ++_agrid_count(p)[_aprop_index(f)];
     _agrid(p) |= f;
 }
 
+static void _unset_agrid_flag(const coord_def& p, areaprop_flag f)
+{
+    uint16_t &count = _agrid_count(p)[_aprop_index(f)];
+    ASSERT(count > 0);
+    if (--count == 0)
+        _agrid(p) &= ~areaprops(f);
+}
+
 static bool _check_agrid_flag(const coord_def& p, areaprop_flag f)
 {
     return bool(_agrid(p) & f);
@@ -79,79 +121,123 @@ void invalidate_agrid(bool recheck_new)
         no_areas = false;
 }
 
-void areas_actor_moved(const actor* act, const coord_def& oldpos)
+// Areas centred on the player that don't come from a radius.
+static void _player_areas(area_footprint &fp)
 {
-    if (act->alive() &&
-        (you.entering_level
-         || act->halo_radius() > -1 || act->silence_radius() > -1
-         || act->liquefying_radius() > -1 || act->umbra_radius() > -1
-#if TAG_MAJOR_VERSION == 34
-         || act->heat_radius() > -1
-#endif
-         ))
+    if (player_has_orb() && !you.pos().origin())
     {
-        // Not necessarily new, but certainly potentially interesting.
-        invalidate_agrid(true);
+        const int r = 2;
+        fp.centres.emplace_back(AREA_ORB, you.pos(), r, MID_PLAYER);
+        for (radius_iterator ri(you.pos(), r, C_SQUARE, LOS_DEFAULT); ri; ++ri)
+            fp.add(*ri, APROP_ORB);
+    }
+
+    if (you.duration[DUR_QUAD_DAMAGE])
+    {
+        const int r = 2;
+        fp.centres.emplace_back(AREA_QUAD, you.pos(), r, MID_PLAYER);
+        for (radius_iterator ri(you.pos(), r, C_SQUARE);
+             ri; ++ri)
+        {
+            if (cell_see_cell(you.pos(), *ri, LOS_DEFAULT))
+                fp.add(*ri, APROP_QUAD);
+        }
+    }
+
+    if (you.duration[DUR_DISJUNCTION])
+    {
+        const int r = 4;
+        fp.centres.emplace_back(AREA_DISJUNCTION, you.pos(), r, MID_PLAYER);
+        for (radius_iterator ri(you.pos(), r, C_SQUARE);
+             ri; ++ri)
+        {
+            if (cell_see_cell(you.pos(), *ri, LOS_DEFAULT))
+                fp.add(*ri, APROP_DISJUNCTION);
+        }
     }
 }
 
-static void _actor_areas(actor *a)
+static void _actor_areas(const actor *a, area_footprint &fp)
 {
     int r;
 
     if ((r = a->silence_radius()) >= 0)
     {
-        _agrid_centres.emplace_back(AREA_SILENCE, a->pos(), r);
+        fp.centres.emplace_back(AREA_SILENCE, a->pos(), r, a->mid);
 
         for (radius_iterator ri(a->pos(), r, C_SQUARE); ri; ++ri)
-            _set_agrid_flag(*ri, APROP_SILENCE);
-        no_areas = false;
+            fp.add(*ri, APROP_SILENCE);
     }
 
     if ((r = a->halo_radius()) >= 0)
     {
-        _agrid_centres.emplace_back(AREA_HALO, a->pos(), r);
+        fp.centres.emplace_back(AREA_HALO, a->pos(), r, a->mid);
 
         for (radius_iterator ri(a->pos(), r, C_SQUARE, LOS_DEFAULT); ri; ++ri)
-            _set_agrid_flag(*ri, APROP_HALO);
-        no_areas = false;
+            fp.add(*ri, APROP_HALO);
     }
 
     if ((r = a->liquefying_radius()) >= 0)
     {
-        _agrid_centres.emplace_back(AREA_LIQUID, a->pos(), r);
+        fp.centres.emplace_back(AREA_LIQUID, a->pos(), r, a->mid);
 
         for (radius_iterator ri(a->pos(), r, C_SQUARE, LOS_SOLID); ri; ++ri)
         {
             dungeon_feature_type f = grd(*ri);
 
-            _set_agrid_flag(*ri, APROP_LIQUID);
+            fp.add(*ri, APROP_LIQUID);
 
             if (feat_has_solid_floor(f) && !feat_is_water(f))
-                _set_agrid_flag(*ri, APROP_ACTUAL_LIQUID);
+                fp.add(*ri, APROP_ACTUAL_LIQUID);
         }
-        no_areas = false;
     }
 
     if ((r = a->umbra_radius()) >= 0)
     {
-        _agrid_centres.emplace_back(AREA_UMBRA, a->pos(), r);
+        fp.centres.emplace_back(AREA_UMBRA, a->pos(), r, a->mid);
 
         for (radius_iterator ri(a->pos(), r, C_SQUARE, LOS_DEFAULT); ri; ++ri)
-            _set_agrid_flag(*ri, APROP_UMBRA);
-        no_areas = false;
+            fp.add(*ri, APROP_UMBRA);
     }
 
 #if TAG_MAJOR_VERSION == 34
     if ((r = a->heat_radius()) >= 0)
     {
-        _agrid_centres.emplace_back(AREA_HOT, a->pos(), r);
+        fp.centres.emplace_back(AREA_HOT, a->pos(), r, a->mid);
 
         for (radius_iterator ri(a->pos(), r, C_SQUARE, LOS_NO_TRANS); ri; ++ri)
-            _set_agrid_flag(*ri, APROP_HOT);
-        no_areas = false;
+            fp.add(*ri, APROP_HOT);
     }
 #endif
+
+    if (a->is_player())
+        _player_areas(fp);
+}
+
+static void _apply_footprint(const area_footprint &fp)
+{
+    for (const auto &cell : fp.cells)
+        _set_agrid_flag(cell.first, cell.second);
+}
+
+static void _unapply_footprint(const area_footprint &fp)
+{
+    for (const auto &cell : fp.cells)
+        _unset_agrid_flag(cell.first, cell.second);
+}
+
+static void _add_actor_areas(const actor *a)
+{
+    area_footprint fp;
+    _actor_areas(a, fp);
+    if (fp.centres.empty())
+        return;
+
+    _apply_footprint(fp);
+    _agrid_centres.insert(_agrid_centres.end(),
+                          fp.centres.begin(), fp.centres.end());
+    _agrid_footprints[a->mid] = move(fp);
+    no_areas = false;
 }
 
 /**
@@ -169,59 +255,109 @@ static void _update_agrid()
     }
 
     _agrid.init(areaprops());
+    _agrid_count.init(FixedVector<uint16_t, NUM_APROPS>(0));
     _agrid_centres.clear();
+    _agrid_footprints.clear();
 
     no_areas = true;
 
-    _actor_areas(&you);
+    _add_actor_areas(&you);
     for (monster_iterator mi; mi; ++mi)
-        _actor_areas(*mi);
+        _add_actor_areas(*mi);
 
-    if (player_has_orb() && !you.pos().origin())
+    if (!env.sunlight.empty())
     {
-        const int r = 2;
-        _agrid_centres.emplace_back(AREA_ORB, you.pos(), r);
-        for (radius_iterator ri(you.pos(), r, C_SQUARE, LOS_DEFAULT); ri; ++ri)
-            _set_agrid_flag(*ri, APROP_ORB);
+        for (const auto &entry : env.sunlight)
+            _set_agrid_flag(entry.first, APROP_HALO);
         no_areas = false;
     }
 
-    if (you.duration[DUR_QUAD_DAMAGE])
-    {
-        const int r = 2;
-        _agrid_centres.emplace_back(AREA_QUAD, you.pos(), r);
-        for (radius_iterator ri(you.pos(), r, C_SQUARE);
-             ri; ++ri)
-        {
-            if (cell_see_cell(you.pos(), *ri, LOS_DEFAULT))
-                _set_agrid_flag(*ri, APROP_QUAD);
-        }
-        no_areas = false;
-    }
+    // TODO: update sanctuary here.
 
-    if (you.duration[DUR_DISJUNCTION])
+    _agrid_valid = true;
+}
+
+/**
+ * Move an actor's areas to its current position, touching only the cells
+ * of its old and new footprint.
+ *
+ * @return false if the grid has to be rebuilt instead: the actor has gained
+ *         or lost an area since the last rebuild, which could change the
+ *         order of the area centres.
+ */
+static bool _move_actor_areas(const actor *a)
+{
+    auto it = _agrid_footprints.find(a->mid);
+
+    area_footprint fp;
+    _actor_areas(a, fp);
+
+    if (it == _agrid_footprints.end())
+        return fp.centres.empty();
+
+    area_footprint &old = it->second;
+    if (fp.centres.size() != old.centres.size())
+        return false;
+    for (unsigned int i = 0; i < fp.centres.size(); ++i)
+        if (fp.centres[i].type != old.centres[i].type)
+            return false;
+
+    _unapply_footprint(old);
+    _apply_footprint(fp);
+
+    unsigned int i = 0;
+    for (area_centre &c : _agrid_centres)
+        if (c.owner == a->mid)
+            c = fp.centres[i++];
+    ASSERT(i == fp.centres.size());
+
+    old = move(fp);
+    return true;
+}
+
+void areas_actor_moved(const actor* act, const coord_def& oldpos)
+{
+    if (!act->alive())
+        return;
+
+    if (you.entering_level)
     {
-        const int r = 4;
-        _agrid_centres.emplace_back(AREA_DISJUNCTION, you.pos(), r);
-        for (radius_iterator ri(you.pos(), r, C_SQUARE);
-             ri; ++ri)
-        {
-            if (cell_see_cell(you.pos(), *ri, LOS_DEFAULT))
-                _set_agrid_flag(*ri, APROP_DISJUNCTION);
-        }
-        no_areas = false;
+        invalidate_agrid(true);
+        return;
     }
 
-    if (!env.sunlight.empty())
+    if (act->halo_radius() > -1 || act->silence_radius() > -1
+        || act->liquefying_radius() > -1 || act->umbra_radius() > -1
+#if TAG_MAJOR_VERSION == 34
+        || act->heat_radius() > -1
+#endif
+        )
     {
-        for (const auto &entry : env.sunlight)
-            _set_agrid_flag(entry.first, APROP_HALO);
-        no_areas = false;
+        // Not necessarily new, but certainly potentially interesting.
+        if (!_agrid_valid || no_areas || !_move_actor_areas(act))
+            invalidate_agrid(true);
     }
+}
 
-    // TODO: update sanctuary here.
+void areas_monster_died(const monster* mons)
+{
+    if (!_agrid_valid)
+        return;
 
-    _agrid_valid = true;
+    auto it = _agrid_footprints.find(mons->mid);
+    if (it == _agrid_footprints.end())
+        return;
+
+    _unapply_footprint(it->second);
+    const mid_t mid = mons->mid;
+    _agrid_centres.erase(remove_if(_agrid_centres.begin(),
+                                   _agrid_centres.end(),
+                                   [mid](const area_centre &c)
+                                   {
+                                       return c.owner == mid;
+                                   }),
+                         _agrid_centres.end());
+    _agrid_footprints.erase(it);
 }
 
 static area_centre_type _get_first_area(const coord_def& f)
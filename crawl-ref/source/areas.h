@@ -20,7 +20,9 @@ enum area_centre_type
 void invalidate_agrid(bool recheck_new = false);
 
 class actor;
+class monster;
 void areas_actor_moved(const actor* act, const coord_def& oldpos);
+void areas_monster_died(const monster* mons);
 
 void create_sanctuary(const coord_def& center, int time);
 bool remove_sanctuary(bool did_attack = false);
@@ -32,6 +32,7 @@
 #include "libutil.h"
 #include "maps.h"
 #include "message.h"
+#include "mon-pathfind.h"
 #include "mon-pick.h"
 #include "mon-util.h"
 #include "ng-init.h"
@@ -182,6 +183,7 @@ void run_tests()
     _run_test("mon-data", debug_mondata);
     _run_test("mon-spell", debug_monspells);
     _run_test("coordit", coordit_tests);
+    _run_test("pathfind", pathfind_tests);
     _run_test("makename", make_name_tests);
     _run_test("job-data", debug_jobdata);
 
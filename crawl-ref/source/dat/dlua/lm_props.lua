@@ -5,6 +5,11 @@
 
 util.defclass("PropertiesDescriptor")
 
+-- A marker class may set immutable_props to true (or to a table of
+-- property names) to promise that those properties never change, so that
+-- the game can cache and index them instead of calling property().
+PropertiesDescriptor.immutable_props = true
+
 function PropertiesDescriptor:new(properties)
   local pd = { }
   setmetatable(pd, self)
@@ -18,6 +18,7 @@
 #include "clua.h"
 #include "end.h"
 #include "files.h"
+#include "flatdb.h"
 #include "libutil.h"
 #include "options.h"
 #include "random.h"
@@ -38,11 +39,9 @@ public:
     ~TextDB() { shutdown(true); delete translation; }
     void init();
     void shutdown(bool recursive = false);
-    DBM* get() { return _db; }
+    const flat_db* get() const { return _db; }
 
-    // Make it easier to migrate from raw DBM* to TextDB
-    operator bool() const { return _db != 0; }
-    operator DBM*() const { return _db; }
+    operator bool() const { return _db != nullptr; }
 
  private:
     bool _needs_update() const;
@@ -53,7 +52,7 @@ public:
     const char* const _db_name;
     string _directory;
     vector<string> _input_files;
-    DBM* _db;
+    flat_db* _db;
     string timestamp;
     TextDB *_parent;
     const char* lang() { return _parent ? Options.lang_name : 0; }
@@ -61,13 +60,13 @@ public:
     TextDB *translation;
 };
 
-// Convenience functions for (read-only) access to generic
-// berkeley DB databases.
-static void _store_text_db(const string &in, DBM *db);
+// Convenience functions for (read-only) access to the compiled text
+// databases.
+static void _store_text_db(const string &in, flat_db_writer &db);
 
 static string _query_database(TextDB &db, string key, bool canonicalise_key,
                               bool run_lua, bool untranslated = false);
-static void _add_entry(DBM *db, const string &k, string &v);
+static void _add_entry(flat_db_writer &db, const string &k, string &v);
 
 static TextDB AllDBs[] =
 {
@@ -194,10 +193,12 @@ bool TextDB::open_db()
     if (_db)
         return true;
 
-    const string full_db_path = _db_cache_path(_db_name, lang());
-    _db = dbm_open(full_db_path.c_str(), O_RDONLY, 0660);
-    if (!_db)
+    _db = new flat_db;
+    if (!_db->open(_db_cache_path(_db_name, lang()) + ".fdb"))
+    {
+        shutdown();
         return false;
+    }
 
     timestamp = _query_database(*this, "TIMESTAMP", false, false, true);
     if (timestamp.empty())
@@ -229,11 +230,8 @@ void TextDB::init()
 
 void TextDB::shutdown(bool recursive)
 {
-    if (_db)
-    {
-        dbm_close(_db);
-        _db = nullptr;
-    }
+    delete _db;
+    _db = nullptr;
     if (recursive && translation)
         translation->shutdown(recursive);
 }
@@ -284,7 +282,6 @@ void TextDB::_regenerate_db()
 #endif
 
     string db_path = _db_cache_path(_db_name, lang());
-    string full_db_path = db_path + ".db";
 
     {
         string output_dir = get_parent_directory(db_path);
@@ -292,14 +289,12 @@ void TextDB::_regenerate_db()
             end(1);
     }
 
+    // The new file is renamed over the old one, so anyone still reading
+    // the old one keeps a consistent copy.
     file_lock lock(db_path + ".lk", "wb");
-#ifndef DGL_REWRITE_PROTECT_DB_FILES
-    unlink_u(full_db_path.c_str());
-#endif
 
     string ts;
-    if (!(_db = dbm_open(db_path.c_str(), O_RDWR | O_CREAT, 0660)))
-        end(1, true, "Unable to open DB: %s", db_path.c_str());
+    flat_db_writer db;
     for (const string &file : _input_files)
     {
         string full_input_path = _directory + file;
@@ -316,13 +311,13 @@ void TextDB::_regenerate_db()
 #endif
             || !_parent) // english is mandatory
         {
-            _store_text_db(full_input_path, _db);
+            _store_text_db(full_input_path, db);
         }
     }
-    _add_entry(_db, "TIMESTAMP", ts);
+    _add_entry(db, "TIMESTAMP", ts);
 
-    dbm_close(_db);
-    _db = 0;
+    if (!db.write(db_path + ".fdb"))
+        end(1, true, "Unable to write DB: %s.fdb", db_path.c_str());
 }
 
 // ----------------------------------------------------------------------
@@ -341,11 +336,6 @@ static void* init_db(void *arg)
 
 void databaseSystemInit()
 {
-    // Note: if you're building contrib libraries initially checked out
-    // before 2011-12-28 and this assertion fails, please make sure you have
-    // the current version ("git submodule sync;git submodule update --init").
-    ASSERT(sqlite3_threadsafe());
-
     thread_t th[NUM_DB];
     for (unsigned int i = 0; i < NUM_DB; i++)
 // Using threads for loading on Windows at the moment seems to cause
@@ -373,24 +363,16 @@ void databaseSystemShutdown()
 ////////////////////////////////////////////////////////////////////////////
 // Main DB functions
 
-static datum _database_fetch(DBM *database, const string &key)
+static string _database_fetch(const flat_db *database, const string &key)
 {
-    datum result;
-    result.dptr = nullptr;
-    result.dsize = 0;
-    datum dbKey;
-
-    dbKey.dptr = (DPTR_COERCE) key.c_str();
-    dbKey.dsize = key.length();
-
     // Don't use the database if called from "monster".
-    if (database)
-        result = dbm_fetch(database, dbKey);
+    if (!database)
+        return "";
 
-    return result;
+    return database->query(key);
 }
 
-static vector<string> _database_find_keys(DBM *database,
+static vector<string> _database_find_keys(const flat_db *database,
                                           const string &regex,
                                           bool ignore_case,
                                           db_find_filter filter = nullptr)
@@ -398,11 +380,9 @@ static vector<string> _database_find_keys(DBM *database,
     text_pattern             tpat(regex, ignore_case);
     vector<string> matches;
 
-    datum dbKey = dbm_firstkey(database);
-
-    while (dbKey.dptr != nullptr)
+    for (unsigned int i = 0; i < database->size(); ++i)
     {
-        string key((const char *)dbKey.dptr, dbKey.dsize);
+        const string key = database->key_at(i);
 
         if (tpat.matches(key)
             && key.find("__") == string::npos
@@ -410,14 +390,12 @@ static vector<string> _database_find_keys(DBM *database,
         {
             matches.push_back(key);
         }
-
-        dbKey = dbm_nextkey(database);
     }
 
     return matches;
 }
 
-static vector<string> _database_find_bodies(DBM *database,
+static vector<string> _database_find_bodies(const flat_db *database,
                                             const string &regex,
                                             bool ignore_case,
                                             db_find_filter filter = nullptr)
@@ -425,14 +403,10 @@ static vector<string> _database_find_bodies(DBM *database,
     text_pattern             tpat(regex, ignore_case);
     vector<string> matches;
 
-    datum dbKey = dbm_firstkey(database);
-
-    while (dbKey.dptr != nullptr)
+    for (unsigned int i = 0; i < database->size(); ++i)
     {
-        string key((const char *)dbKey.dptr, dbKey.dsize);
-
-        datum dbBody = dbm_fetch(database, dbKey);
-        string body((const char *)dbBody.dptr, dbBody.dsize);
+        const string key = database->key_at(i);
+        const string body = database->value_at(i);
 
         if (tpat.matches(body)
             && key.find("__") == string::npos
@@ -440,8 +414,6 @@ static vector<string> _database_find_bodies(DBM *database,
         {
             matches.push_back(key);
         }
-
-        dbKey = dbm_nextkey(database);
     }
 
     return matches;
@@ -488,21 +460,13 @@ static void _trim_leading_newlines(string &s)
     s.erase(0, s.find_first_not_of("\n"));
 }
 
-static void _add_entry(DBM *db, const string &k, string &v)
+static void _add_entry(flat_db_writer &db, const string &k, string &v)
 {
     _trim_leading_newlines(v);
-    datum key, value;
-    key.dptr = (char *) k.c_str();
-    key.dsize = k.length();
-
-    value.dptr = (char *) v.c_str();
-    value.dsize = v.length();
-
-    if (dbm_store(db, key, value, DBM_REPLACE))
-        end(1, true, "Error storing %s", k.c_str());
+    db.add(k, v);
 }
 
-static void _parse_text_db(LineInput &inf, DBM *db)
+static void _parse_text_db(LineInput &inf, flat_db_writer &db)
 {
     string key;
     string value;
@@ -545,7 +509,7 @@ static void _parse_text_db(LineInput &inf, DBM *db)
         _add_entry(db, key, value);
 }
 
-static void _store_text_db(const string &in, DBM *db)
+static void _store_text_db(const string &in, flat_db_writer &db)
 {
     UTF8FileLineInput inf(in.c_str());
     if (inf.error())
@@ -625,14 +589,14 @@ static string _getWeightedString(TextDB &db, const string &key,
     lowercase(canonical_key);
 
     // Query the DB.
-    datum result;
+    string result;
 
     if (db.translation)
         result = _database_fetch(db.translation->get(), canonical_key);
-    if (result.dsize <= 0)
+    if (result.empty())
         result = _database_fetch(db.get(), canonical_key);
 
-    if (result.dsize <= 0)
+    if (result.empty())
     {
         // Try ignoring the suffix.
         canonical_key = key;
@@ -641,17 +605,14 @@ static string _getWeightedString(TextDB &db, const string &key,
         // Query the DB.
         if (db.translation)
             result = _database_fetch(db.translation->get(), canonical_key);
-        if (result.dsize <= 0)
+        if (result.empty())
             result = _database_fetch(db.get(), canonical_key);
 
-        if (result.dsize <= 0)
+        if (result.empty())
             return "";
     }
 
-    // Cons up a (C++) string to return. The caller must release it.
-    string str = string((const char *)result.dptr, result.dsize);
-
-    return _chooseStrByWeight(str, fixed_weight);
+    return _chooseStrByWeight(result, fixed_weight);
 }
 
 static void _call_recursive_replacement(string &str, TextDB &db,
@@ -739,18 +700,16 @@ static string _query_database(TextDB &db, string key, bool canonicalise_key,
     }
 
     // Query the DB.
-    datum result;
+    string str;
 
     if (db.translation && !untranslated)
-        result = _database_fetch(db.translation->get(), key);
-    if (result.dsize <= 0)
-        result = _database_fetch(db.get(), key);
+        str = _database_fetch(db.translation->get(), key);
+    if (str.empty())
+        str = _database_fetch(db.get(), key);
 
-    if (result.dsize <= 0)
+    if (str.empty())
         return "";
 
-    string str((const char *)result.dptr, result.dsize);
-
     // <foo> is an alias to key foo
     if (str[0] == '<' && str[str.size() - 2] == '>'
         && str.find('<', 1) == str.npos
@@ -808,8 +767,7 @@ vector<string> getLongDescBodiesByRegex(const string &regex,
     // On partial translations, this will match only translated descriptions.
     // Not good, but otherwise we'd have to check hundreds of keys, with
     // two queries for each.
-    // SQL can do this in one go, DBM can't.
-    DBM *database = DescriptionDB.translation ?
+    const flat_db *database = DescriptionDB.translation ?
         DescriptionDB.translation->get() : DescriptionDB.get();
     return _database_find_bodies(database, regex, true, filter);
 }
@@ -7,11 +7,18 @@
 
 #include "dbg-maps.h"
 
+#ifdef UNIX
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include "branch.h"
 #include "chardump.h"
 #include "crash.h"
 #include "dbg-objstat.h"
+#include "dgn-profile.h"
 #include "dungeon.h"
+#include "end.h"
 #include "env.h"
 #include "initfile.h"
 #include "libutil.h"
@@ -19,9 +26,11 @@
 #include "message.h"
 #include "ng-init.h"
 #include "player.h"
+#include "random.h"
 #include "shopping.h"
 #include "state.h"
 #include "stringutil.h"
+#include "tags.h"
 #include "view.h"
 
 #ifdef DEBUG_STATISTICS
@@ -45,6 +54,9 @@ static int build_attempts = 0, level_vetoes = 0;
 // Map from message to counts.
 static map<string, int> veto_messages;
 
+// Set in the worker processes of a parallel (-jobs) run.
+static bool stat_worker = false;
+
 void mapstat_report_map_build_start()
 {
     build_attempts++;
@@ -84,7 +96,7 @@ static bool _do_build_level()
     watchdog();
 
     no_messages mx;
-    if (kbhit() && key_is_escape(getchk()))
+    if (!stat_worker && kbhit() && key_is_escape(getchk()))
     {
         mprf(MSGCH_WARN, "User requested cancel");
         return false;
@@ -226,26 +238,10 @@ static bool _build_dungeon()
     return true;
 }
 
-/**
- * Build dungeon levels for mapstat or objstat.
- *
- * The exact branches/levels built and number of build iterations is set by the
- * command-line options for mapstat/objstat.
-
- * @returns True if all iterations built successfully. For mapstat, this can
- * return false if an iteration produced a disconnected level, since for
- * diagnostic purposes we record the map in detail to a file and exit. For
- * objstat, this only returns false if the primary dungeon generation function
- * builder() fails, as the level may be in an invalid state and any object
- * statistics erroneous.
-*/
-bool mapstat_build_levels()
+// Build iterations [first, last) of the dungeon.
+static bool _build_iterations(int first, int last)
 {
-    if (!generated_levels.size())
-        _dungeon_places();
-    printf("Iteration: ");
-    fflush(stdout);
-    for (int i = 0; i < SysEnv.map_gen_iters; ++i)
+    for (int i = first; i < last; ++i)
     {
         clear_messages();
         mprf("On %d of %d; %d g, %d fail, %u err%s, %u uniq, "
@@ -268,6 +264,254 @@ bool mapstat_build_levels()
         if (crawl_state.obj_stat_gen)
             objstat_iteration_stats();
     }
+    return true;
+}
+
+#ifdef UNIX
+// Send a worker's map stats (and objstat tables) back to the parent.
+static void _save_worker_stats(writer &th, bool ok)
+{
+    marshallBoolean(th, ok);
+    marshallInt(th, levels_tried);
+    marshallInt(th, levels_failed);
+    marshallInt(th, build_attempts);
+    marshallInt(th, level_vetoes);
+    marshallString(th, last_error);
+
+    marshallInt(th, try_count.size());
+    for (const auto &entry : try_count)
+    {
+        marshallString(th, entry.first);
+        marshallInt(th, entry.second);
+    }
+    marshallInt(th, use_count.size());
+    for (const auto &entry : use_count)
+    {
+        marshallString(th, entry.first);
+        marshallInt(th, entry.second);
+    }
+    marshallInt(th, veto_messages.size());
+    for (const auto &entry : veto_messages)
+    {
+        marshallString(th, entry.first);
+        marshallInt(th, entry.second);
+    }
+    marshallInt(th, errors.size());
+    for (const auto &entry : errors)
+    {
+        marshallString(th, entry.first);
+        marshallString(th, entry.second);
+    }
+
+    marshallInt(th, level_mapcounts.size());
+    for (const auto &entry : level_mapcounts)
+    {
+        marshall_level_id(th, entry.first);
+        marshallInt(th, entry.second);
+    }
+    marshallInt(th, map_builds.size());
+    for (const auto &entry : map_builds)
+    {
+        marshall_level_id(th, entry.first);
+        marshallInt(th, entry.second.first);
+        marshallInt(th, entry.second.second);
+    }
+    marshallInt(th, level_mapsused.size());
+    for (const auto &entry : level_mapsused)
+    {
+        marshall_level_id(th, entry.first);
+        marshallInt(th, entry.second.size());
+        for (const string &name : entry.second)
+            marshallString(th, name);
+    }
+    marshallInt(th, map_levelsused.size());
+    for (const auto &entry : map_levelsused)
+    {
+        marshallString(th, entry.first);
+        marshallInt(th, entry.second.size());
+        for (const level_id &lid : entry.second)
+            marshall_level_id(th, lid);
+    }
+    dgn_profile_save(th);
+
+    if (crawl_state.obj_stat_gen)
+        objstat_save_stats(th);
+}
+
+// Add a worker's stats to ours. Returns whether all its levels built.
+static bool _merge_worker_stats(reader &th)
+{
+    const bool ok = unmarshallBoolean(th);
+    levels_tried += unmarshallInt(th);
+    levels_failed += unmarshallInt(th);
+    build_attempts += unmarshallInt(th);
+    level_vetoes += unmarshallInt(th);
+    const string err = unmarshallString(th);
+    if (!err.empty())
+        last_error = err;
+
+    for (int n = unmarshallInt(th); n > 0; --n)
+    {
+        const string name = unmarshallString(th);
+        try_count[name] += unmarshallInt(th);
+    }
+    for (int n = unmarshallInt(th); n > 0; --n)
+    {
+        const string name = unmarshallString(th);
+        use_count[name] += unmarshallInt(th);
+    }
+    for (int n = unmarshallInt(th); n > 0; --n)
+    {
+        const string message = unmarshallString(th);
+        veto_messages[message] += unmarshallInt(th);
+    }
+    for (int n = unmarshallInt(th); n > 0; --n)
+    {
+        const string name = unmarshallString(th);
+        errors[name] = unmarshallString(th);
+    }
+
+    for (int n = unmarshallInt(th); n > 0; --n)
+    {
+        const level_id lid = unmarshall_level_id(th);
+        level_mapcounts[lid] += unmarshallInt(th);
+    }
+    for (int n = unmarshallInt(th); n > 0; --n)
+    {
+        const level_id lid = unmarshall_level_id(th);
+        map_builds[lid].first += unmarshallInt(th);
+        map_builds[lid].second += unmarshallInt(th);
+    }
+    for (int n = unmarshallInt(th); n > 0; --n)
+    {
+        set<string> &maps = level_mapsused[unmarshall_level_id(th)];
+        for (int m = unmarshallInt(th); m > 0; --m)
+            maps.insert(unmarshallString(th));
+    }
+    for (int n = unmarshallInt(th); n > 0; --n)
+    {
+        set<level_id> &levels = map_levelsused[unmarshallString(th)];
+        for (int m = unmarshallInt(th); m > 0; --m)
+            levels.insert(unmarshall_level_id(th));
+    }
+    dgn_profile_merge(th);
+
+    if (crawl_state.obj_stat_gen)
+        objstat_merge_stats(th);
+
+    return ok;
+}
+
+/**
+ * Split the iterations between SysEnv.map_gen_jobs forked worker processes.
+ *
+ * Each worker gets a contiguous run of iterations and its own RNG seed,
+ * derived from the -seed option if one was given, so a run can be
+ * repeated. The workers' stats are merged in worker order once they have
+ * all finished.
+ */
+static bool _build_iterations_in_workers()
+{
+    const int jobs = min(SysEnv.map_gen_jobs, SysEnv.map_gen_iters);
+    const uint32_t base_seed = Options.seed ? Options.seed : random_int();
+
+    vector<pid_t> pids;
+    vector<FILE *> results;
+    for (int job = 0; job < jobs; ++job)
+    {
+        int fds[2];
+        if (pipe(fds) == -1)
+            end(1, true, "Can't create pipe for stat worker");
+
+        fflush(stdout);
+        fflush(stderr);
+        const pid_t pid = fork();
+        if (pid == -1)
+            end(1, true, "Can't fork stat worker");
+
+        if (!pid)
+        {
+            close(fds[0]);
+            for (FILE *f : results)
+                fclose(f);
+
+            stat_worker = true;
+            seed_rng(base_seed + job);
+            const bool ok = _build_iterations(
+                                job * SysEnv.map_gen_iters / jobs,
+                                (job + 1) * SysEnv.map_gen_iters / jobs);
+
+            FILE *outf = fdopen(fds[1], "wb");
+            {
+                writer th("stat worker", outf);
+                _save_worker_stats(th, ok);
+            }
+            fclose(outf);
+            fflush(stdout);
+            _exit(0);
+        }
+
+        close(fds[1]);
+        pids.push_back(pid);
+        results.push_back(fdopen(fds[0], "rb"));
+    }
+
+    bool ok = true;
+    for (int job = 0; job < jobs; ++job)
+    {
+        try
+        {
+            reader th(results[job]);
+            if (!_merge_worker_stats(th))
+                ok = false;
+        }
+        catch (short_read_exception &E)
+        {
+            fprintf(stderr, "Stat worker %d died without reporting.\n", job);
+            ok = false;
+        }
+        fclose(results[job]);
+
+        int status;
+        if (waitpid(pids[job], &status, 0) == -1
+            || !WIFEXITED(status) || WEXITSTATUS(status))
+        {
+            ok = false;
+        }
+    }
+    return ok;
+}
+#endif
+
+/**
+ * Build dungeon levels for mapstat or objstat.
+ *
+ * The exact branches/levels built and number of build iterations is set by the
+ * command-line options for mapstat/objstat. With -jobs, the iterations are
+ * shared out between worker processes.
+
+ * @returns True if all iterations built successfully. For mapstat, this can
+ * return false if an iteration produced a disconnected level, since for
+ * diagnostic purposes we record the map in detail to a file and exit. For
+ * objstat, this only returns false if the primary dungeon generation function
+ * builder() fails, as the level may be in an invalid state and any object
+ * statistics erroneous.
+*/
+bool mapstat_build_levels()
+{
+    if (!generated_levels.size())
+        _dungeon_places();
+    printf("Iteration: ");
+    fflush(stdout);
+    bool ok;
+#ifdef UNIX
+    if (SysEnv.map_gen_jobs > 1 && SysEnv.map_gen_iters > 1)
+        ok = _build_iterations_in_workers();
+    else
+#endif
+        ok = _build_iterations(0, SysEnv.map_gen_iters);
+    if (!ok)
+        return false;
     printf("Finished.\n");
     fflush(stdout);
     return true;
@@ -503,6 +747,11 @@ void mapstat_generate_stats()
     // build.
     mapstat_build_levels();
     _write_map_stats();
+
+    const char *profile_file = "mapstat-profile.json";
+    printf("Writing level generation profile to %s...\n", profile_file);
+    if (!dgn_profile_write_json(profile_file))
+        fprintf(stderr, "Couldn't write %s\n", profile_file);
     printf("Map stats complete.\n");
 }
 
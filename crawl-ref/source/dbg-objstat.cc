@@ -38,6 +38,7 @@
 #include "state.h"
 #include "stepdown.h"
 #include "stringutil.h"
+#include "tags.h"
 #include "terrain.h"
 #include "version.h"
 
@@ -872,6 +873,135 @@ void objstat_iteration_stats()
     }
 }
 
+// Passing the stat tables between mapstat worker processes. The tables
+// are written key by key, and merged into ours by adding counts and
+// totals, or taking the min/max for the NumMin/NumMax style fields.
+
+static void _marshall_stats(writer &th, int value)
+{
+    marshallInt(th, value);
+}
+
+static void _merge_stats(reader &th, int &total)
+{
+    total += unmarshallInt(th);
+}
+
+static void _marshall_stats(writer &th, const map<string, double> &stats)
+{
+    marshallInt(th, stats.size());
+    for (const auto &entry : stats)
+    {
+        marshallString(th, entry.first);
+        // Bit for bit, since the min fields start out as INFINITY.
+        uint64_t bits;
+        memcpy(&bits, &entry.second, sizeof(bits));
+        marshallUnsigned(th, bits);
+    }
+}
+
+static void _merge_stats(reader &th, map<string, double> &stats)
+{
+    for (int n = unmarshallInt(th); n > 0; --n)
+    {
+        const string field = unmarshallString(th);
+        const uint64_t bits = unmarshallUnsigned(th);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+
+        double &total = stats[field];
+        if (ends_with(field, "Min"))
+            total = min(total, value);
+        else if (ends_with(field, "Max"))
+            total = max(total, value);
+        else
+            total += value;
+    }
+}
+
+static void _marshall_key(writer &th, const level_id &lev)
+{
+    marshall_level_id(th, lev);
+}
+
+static void _marshall_key(writer &th, int key)
+{
+    marshallInt(th, key);
+}
+
+static void _unmarshall_key(reader &th, level_id &lev)
+{
+    lev = unmarshall_level_id(th);
+}
+
+static void _unmarshall_key(reader &th, int &key)
+{
+    key = unmarshallInt(th);
+}
+
+template <typename K, typename T>
+static void _marshall_stats(writer &th, const map<K, T> &stats);
+template <typename K, typename T>
+static void _merge_stats(reader &th, map<K, T> &stats);
+
+template <typename T>
+static void _marshall_stats(writer &th, const vector<T> &stats)
+{
+    marshallInt(th, stats.size());
+    for (const T &entry : stats)
+        _marshall_stats(th, entry);
+}
+
+template <typename T>
+static void _merge_stats(reader &th, vector<T> &stats)
+{
+    const unsigned int size = unmarshallInt(th);
+    if (stats.size() < size)
+        stats.resize(size);
+    for (unsigned int i = 0; i < size; ++i)
+        _merge_stats(th, stats[i]);
+}
+
+template <typename K, typename T>
+static void _marshall_stats(writer &th, const map<K, T> &stats)
+{
+    marshallInt(th, stats.size());
+    for (const auto &entry : stats)
+    {
+        _marshall_key(th, entry.first);
+        _marshall_stats(th, entry.second);
+    }
+}
+
+template <typename K, typename T>
+static void _merge_stats(reader &th, map<K, T> &stats)
+{
+    for (int n = unmarshallInt(th); n > 0; --n)
+    {
+        K key;
+        _unmarshall_key(th, key);
+        _merge_stats(th, stats[key]);
+    }
+}
+
+void objstat_save_stats(writer &th)
+{
+    _marshall_stats(th, item_recs);
+    _marshall_stats(th, weapon_brands);
+    _marshall_stats(th, armour_brands);
+    _marshall_stats(th, missile_brands);
+    _marshall_stats(th, monster_recs);
+}
+
+void objstat_merge_stats(reader &th)
+{
+    _merge_stats(th, item_recs);
+    _merge_stats(th, weapon_brands);
+    _merge_stats(th, armour_brands);
+    _merge_stats(th, missile_brands);
+    _merge_stats(th, monster_recs);
+}
+
 static void _write_stat_headers(const vector<string> &fields, bool items = true)
 {
     fprintf(stat_outf, "%s\tLevel", items ? "Item" : "Monster");
@@ -7,10 +7,15 @@
 #define DBGOBJSTAT_H
 
 #ifdef DEBUG_STATISTICS
+class reader;
+class writer;
+
 void objstat_record_item(const item_def &item);
 void objstat_generate_stats();
 void objstat_record_monster(const monster *mons);
 void objstat_iteration_stats();
+void objstat_save_stats(writer &th);
+void objstat_merge_stats(reader &th);
 #endif
 
 #endif //DBGOBJSTAT_H
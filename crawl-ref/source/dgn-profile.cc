@@ -0,0 +1,257 @@
+/**
+ * @file
+ * @brief Level generation profiling: phase timings and veto counts.
+**/
+
+#include "AppHdr.h"
+
+#include "dgn-profile.h"
+
+#include <chrono>
+
+#include "branch.h"
+#include "files.h"
+#include "json.h"
+#include "json-wrapper.h"
+#include "options.h"
+#include "player.h"
+#include "state.h"
+#include "syscalls.h"
+#include "tags.h"
+
+static const char *phase_names[] =
+{
+    "level", "layout", "primary_vault", "vaults", "connectivity",
+    "monsters", "items", "fixup", "lua",
+};
+COMPILE_CHECK(ARRAYSZ(phase_names) == NUM_DGN_PHASES);
+
+struct dgn_phase_stats
+{
+    int count;
+    uint64_t total_us;
+    uint64_t max_us;
+};
+
+struct dgn_level_stats
+{
+    int builds;     // calls to builder()
+    int failures;   // builds that ran out of retries
+    int attempts;   // calls to _build_level_vetoable()
+    dgn_phase_stats phases[NUM_DGN_PHASES];
+    map<string, int> vetoes;
+
+    dgn_level_stats() : builds(0), failures(0), attempts(0), phases()
+    {
+    }
+
+    void merge(const dgn_level_stats &other);
+};
+
+// The level currently being built, and every level built so far.
+static dgn_level_stats current_level;
+static map<level_id, dgn_level_stats> level_stats;
+static uint64_t level_start;
+
+// How many timers of each phase are running.
+static int phase_depth[NUM_DGN_PHASES];
+
+static uint64_t _now_us()
+{
+    return chrono::duration_cast<chrono::microseconds>(
+               chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void _record_phase(dgn_level_stats &stats, dgn_phase_type phase,
+                          uint64_t us)
+{
+    dgn_phase_stats &ps = stats.phases[phase];
+    ps.count++;
+    ps.total_us += us;
+    ps.max_us = max(ps.max_us, us);
+}
+
+void dgn_level_stats::merge(const dgn_level_stats &other)
+{
+    builds += other.builds;
+    failures += other.failures;
+    attempts += other.attempts;
+    for (int i = 0; i < NUM_DGN_PHASES; ++i)
+    {
+        phases[i].count += other.phases[i].count;
+        phases[i].total_us += other.phases[i].total_us;
+        phases[i].max_us = max(phases[i].max_us, other.phases[i].max_us);
+    }
+    for (const auto &veto : other.vetoes)
+        vetoes[veto.first] += veto.second;
+}
+
+dgn_phase_timer::dgn_phase_timer(dgn_phase_type _phase)
+    : phase(_phase), start(0)
+{
+    if (!phase_depth[phase]++)
+        start = _now_us();
+}
+
+dgn_phase_timer::~dgn_phase_timer()
+{
+    if (!--phase_depth[phase])
+        _record_phase(current_level, phase, _now_us() - start);
+}
+
+void dgn_profile_start_level()
+{
+    current_level = dgn_level_stats();
+    current_level.builds = 1;
+    level_start = _now_us();
+}
+
+void dgn_profile_record_attempt()
+{
+    current_level.attempts++;
+}
+
+void dgn_profile_record_veto(const string &reason)
+{
+    ++current_level.vetoes[reason];
+}
+
+static JsonNode *_level_stats_json(const dgn_level_stats &stats)
+{
+    JsonNode *level(json_mkobject());
+    json_append_member(level, "builds", json_mknumber(stats.builds));
+    json_append_member(level, "failures", json_mknumber(stats.failures));
+    json_append_member(level, "attempts", json_mknumber(stats.attempts));
+
+    JsonNode *phases(json_mkobject());
+    for (int i = 0; i < NUM_DGN_PHASES; ++i)
+    {
+        const dgn_phase_stats &ps = stats.phases[i];
+        if (!ps.count)
+            continue;
+
+        JsonNode *phase(json_mkobject());
+        json_append_member(phase, "count", json_mknumber(ps.count));
+        json_append_member(phase, "total_ms",
+                           json_mknumber(ps.total_us / 1000.0));
+        json_append_member(phase, "max_ms", json_mknumber(ps.max_us / 1000.0));
+        json_append_member(phases, phase_names[i], phase);
+    }
+    json_append_member(level, "phases", phases);
+
+    JsonNode *vetoes(json_mkobject());
+    for (const auto &veto : stats.vetoes)
+        json_append_member(vetoes, veto.first.c_str(),
+                           json_mknumber(veto.second));
+    json_append_member(level, "vetoes", vetoes);
+
+    return level;
+}
+
+// Append a line about a slow level to the levelgen log, for servers.
+static void _log_slow_level(const level_id &lid, uint64_t us)
+{
+    if (!Options.level_gen_log_ms
+        || us < (uint64_t)Options.level_gen_log_ms * 1000
+        || crawl_state.map_stat_gen || crawl_state.obj_stat_gen)
+    {
+        return;
+    }
+
+    JsonWrapper json(_level_stats_json(current_level));
+    json_prepend_member(json.node, "place",
+                        json_mkstring(lid.describe().c_str()));
+    json_prepend_member(json.node, "name",
+                        json_mkstring(you.your_name.c_str()));
+
+    const string log_file =
+        Options.save_dir + "levelgen" + crawl_state.game_type_qualifier();
+    if (FILE *fp = lk_open("a", log_file))
+    {
+        fprintf(fp, "%s\n", json.to_string().c_str());
+        lk_close(fp, log_file);
+    }
+}
+
+void dgn_profile_finish_level(bool built)
+{
+    const uint64_t us = _now_us() - level_start;
+    _record_phase(current_level, DGN_PHASE_LEVEL, us);
+    if (!built)
+        current_level.failures++;
+
+    const level_id lid = level_id::current();
+    _log_slow_level(lid, us);
+    level_stats[lid].merge(current_level);
+}
+
+void dgn_profile_save(writer &th)
+{
+    marshallInt(th, level_stats.size());
+    for (const auto &entry : level_stats)
+    {
+        const dgn_level_stats &stats = entry.second;
+        marshall_level_id(th, entry.first);
+        marshallInt(th, stats.builds);
+        marshallInt(th, stats.failures);
+        marshallInt(th, stats.attempts);
+        for (const dgn_phase_stats &ps : stats.phases)
+        {
+            marshallInt(th, ps.count);
+            marshallUnsigned(th, ps.total_us);
+            marshallUnsigned(th, ps.max_us);
+        }
+        marshallInt(th, stats.vetoes.size());
+        for (const auto &veto : stats.vetoes)
+        {
+            marshallString(th, veto.first);
+            marshallInt(th, veto.second);
+        }
+    }
+}
+
+void dgn_profile_merge(reader &th)
+{
+    for (int n = unmarshallInt(th); n > 0; --n)
+    {
+        const level_id lid = unmarshall_level_id(th);
+        dgn_level_stats stats;
+        stats.builds = unmarshallInt(th);
+        stats.failures = unmarshallInt(th);
+        stats.attempts = unmarshallInt(th);
+        for (dgn_phase_stats &ps : stats.phases)
+        {
+            ps.count = unmarshallInt(th);
+            ps.total_us = unmarshallUnsigned(th);
+            ps.max_us = unmarshallUnsigned(th);
+        }
+        for (int m = unmarshallInt(th); m > 0; --m)
+        {
+            const string reason = unmarshallString(th);
+            stats.vetoes[reason] = unmarshallInt(th);
+        }
+        level_stats[lid].merge(stats);
+    }
+}
+
+bool dgn_profile_write_json(const string &filename)
+{
+    JsonWrapper json(json_mkobject());
+    dgn_level_stats total;
+    for (const auto &entry : level_stats)
+    {
+        json_append_member(json.node, entry.first.describe().c_str(),
+                           _level_stats_json(entry.second));
+        total.merge(entry.second);
+    }
+    json_prepend_member(json.node, "total", _level_stats_json(total));
+
+    FILE *outf = fopen_u(filename.c_str(), "w");
+    if (!outf)
+        return false;
+
+    char *s = json_stringify(json.node, "  ");
+    const bool ok = s && fprintf(outf, "%s\n", s) > 0;
+    free(s);
+    return !fclose(outf) && ok;
+}
@@ -0,0 +1,53 @@
+/**
+ * @file
+ * @brief Level generation profiling: phase timings and veto counts.
+**/
+
+#ifndef DGNPROFILE_H
+#define DGNPROFILE_H
+
+class reader;
+class writer;
+
+// Timed parts of level generation. The times are inclusive: the layout
+// contains the primary vault, and any phase may contain Lua.
+enum dgn_phase_type
+{
+    DGN_PHASE_LEVEL,          // all of builder(), including retries
+    DGN_PHASE_LAYOUT,
+    DGN_PHASE_PRIMARY_VAULT,
+    DGN_PHASE_VAULTS,         // branch entries, chance vaults, minivaults
+    DGN_PHASE_CONNECTIVITY,
+    DGN_PHASE_MONSTERS,
+    DGN_PHASE_ITEMS,
+    DGN_PHASE_FIXUP,
+    DGN_PHASE_LUA,            // map and branch Lua chunks and hooks
+    NUM_DGN_PHASES
+};
+
+// Times a phase for as long as it is in scope. Only the outermost timer
+// of each phase counts, so phases may be entered recursively.
+class dgn_phase_timer
+{
+public:
+    dgn_phase_timer(dgn_phase_type phase);
+    ~dgn_phase_timer();
+
+private:
+    dgn_phase_type phase;
+    uint64_t start;
+
+    DISALLOW_COPY_AND_ASSIGN(dgn_phase_timer);
+};
+
+void dgn_profile_start_level();
+void dgn_profile_record_attempt();
+void dgn_profile_record_veto(const string &reason);
+void dgn_profile_finish_level(bool built);
+
+// For mapstat: the stats for every level built so far.
+void dgn_profile_save(writer &th);
+void dgn_profile_merge(reader &th);
+bool dgn_profile_write_json(const string &filename);
+
+#endif
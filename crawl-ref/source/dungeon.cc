@@ -34,6 +34,7 @@
 #include "dgn-height.h"
 #include "dgn-labyrinth.h"
 #include "dgn-overview.h"
+#include "dgn-profile.h"
 #include "dgn-shoals.h"
 #include "end.h"
 #include "english.h"
@@ -291,6 +292,7 @@ bool builder(bool enable_random_maps, dungeon_feature_type dest_stairs_type)
     temp_unique_items = you.unique_items;
 
     unwind_bool levelgen(crawl_state.generating_level, true);
+    dgn_profile_start_level();
 
     // N tries to build the level, after which we bail with a capital B.
     int tries = 50;
@@ -311,6 +313,7 @@ bool builder(bool enable_random_maps, dungeon_feature_type dest_stairs_type)
                 if (you.props.exists(GOZAG_ANNOUNCE_SHOP_KEY))
                     unmark_offlevel_shop(level_id::current());
 
+                dgn_profile_finish_level(true);
                 return true;
             }
         }
@@ -325,6 +328,8 @@ bool builder(bool enable_random_maps, dungeon_feature_type dest_stairs_type)
         you.uniq_map_names = uniq_names;
     }
 
+    dgn_profile_finish_level(false);
+
     if (!crawl_state.map_stat_gen && !crawl_state.obj_stat_gen)
     {
         // Failed to build level, bail out.
@@ -351,6 +356,7 @@ static bool _build_level_vetoable(bool enable_random_maps,
 #ifdef DEBUG_DIAGNOSTICS
     mapstat_report_map_build_start();
 #endif
+    dgn_profile_record_attempt();
 
     dgn_reset_level(enable_random_maps);
 
@@ -368,6 +374,7 @@ static bool _build_level_vetoable(bool enable_random_maps,
 #ifdef DEBUG_DIAGNOSTICS
         mapstat_report_map_veto(e.what());
 #endif
+        dgn_profile_record_veto(e.what());
         return false;
     }
 
@@ -376,6 +383,7 @@ static bool _build_level_vetoable(bool enable_random_maps,
     if (crawl_state.game_standard_levelgen()
         && !_valid_dungeon_level())
     {
+        dgn_profile_record_veto("Invalid level");
         return false;
     }
 
@@ -410,13 +418,17 @@ static bool _build_level_vetoable(bool enable_random_maps,
 
     // Call the branch epilogue, if any.
     if (!branch_epilogues[you.where_are_you].empty())
+    {
+        dgn_phase_timer timer(DGN_PHASE_LUA);
         if (!dlua.callfn(branch_epilogues[you.where_are_you].c_str(), 0, 0))
         {
             mprf(MSGCH_ERROR, "branch epilogue for %s failed: %s",
                               level_id::current().describe().c_str(),
                               dlua.error.c_str());
+            dgn_profile_record_veto("Branch epilogue failed");
             return false;
         }
+    }
 
     // Discard any Lua chunks we loaded.
     strip_all_maps();
@@ -452,6 +464,7 @@ static void _builder_assertions()
 // fixups.
 static void _dgn_postprocess_level()
 {
+    dgn_phase_timer timer(DGN_PHASE_FIXUP);
     shoals_postprocess_level();
     _builder_assertions();
     _calc_density();
@@ -1270,6 +1283,7 @@ static int _num_mons_wanted()
 
 static void _fixup_walls()
 {
+    dgn_phase_timer timer(DGN_PHASE_FIXUP);
     // If level part of Dis -> all walls metal.
     // If Vaults:$ -> all walls metal or crystal.
     // If part of crypt -> all walls stone.
@@ -1356,6 +1370,7 @@ void fixup_misplaced_items()
 
 static void _fixup_branch_stairs()
 {
+    dgn_phase_timer timer(DGN_PHASE_FIXUP);
     // Top level of branch levels - replaces up stairs with stairs back to
     // dungeon or wherever:
     if (you.depth == 1)
@@ -1789,6 +1804,7 @@ static bool _branch_needs_stairs()
 
 static void _dgn_verify_connectivity(unsigned nvaults)
 {
+    dgn_phase_timer timer(DGN_PHASE_CONNECTIVITY);
     // After placing vaults, make sure parts of the level have not been
     // disconnected.
     if (dgn_zones && nvaults != env.level_vaults.size())
@@ -2513,6 +2529,7 @@ static bool _pan_level()
 // to place more vaults after this
 static bool _builder_by_type()
 {
+    dgn_phase_timer timer(DGN_PHASE_LAYOUT);
     if (player_in_branch(BRANCH_LABYRINTH))
     {
         dgn_build_labyrinth_level();
@@ -2932,6 +2949,7 @@ static void _slime_connectivity_fixup()
 // Place vaults with CHANCE: that want to be placed on this level.
 static void _place_chance_vaults()
 {
+    dgn_phase_timer timer(DGN_PHASE_VAULTS);
     const level_id &lid(level_id::current());
     mapref_vector maps = random_chance_maps_in_depth(lid);
     // [ds] If there are multiple CHANCE maps that share an luniq_ or
@@ -2970,6 +2988,7 @@ static void _place_chance_vaults()
 
 static void _place_minivaults()
 {
+    dgn_phase_timer timer(DGN_PHASE_VAULTS);
     const map_def *vault = nullptr;
     // First place the vault requested with &P
     if (you.props.exists("force_minivault")
@@ -3367,6 +3386,7 @@ static bool _place_vault_by_tag(const string &tag)
 
 static void _place_branch_entrances(bool use_vaults)
 {
+    dgn_phase_timer timer(DGN_PHASE_VAULTS);
     // Find what branch entrances are already placed, and what branch
     // entrances could be placed here.
     bool branch_entrance_placed[NUM_BRANCHES];
@@ -3452,6 +3472,7 @@ static void _place_branch_entrances(bool use_vaults)
 
 static void _place_extra_vaults()
 {
+    dgn_phase_timer timer(DGN_PHASE_VAULTS);
     int tries = 0;
     while (true)
     {
@@ -3675,6 +3696,7 @@ bool door_vetoed(const coord_def pos)
 
 static void _builder_monsters()
 {
+    dgn_phase_timer timer(DGN_PHASE_MONSTERS);
     if (player_in_branch(BRANCH_TEMPLE))
         return;
 
@@ -3746,6 +3768,7 @@ static void _randomly_place_item(int item)
  */
 static void _builder_items()
 {
+    dgn_phase_timer timer(DGN_PHASE_ITEMS);
     int i = 0;
     object_class_type specif_type = OBJ_RANDOM;
     int items_levels = env.absdepth0;
@@ -4028,6 +4051,7 @@ static const vault_placement *_build_secondary_vault(const map_def *vault,
 //
 static const vault_placement *_build_primary_vault(const map_def *vault)
 {
+    dgn_phase_timer timer(DGN_PHASE_PRIMARY_VAULT);
     return _build_vault_impl(vault);
 }
 
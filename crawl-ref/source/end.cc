@@ -19,7 +19,6 @@
 #include "hints.h"
 #include "invent.h"
 #include "itemprop.h"
-#include "los.h"
 #include "macro.h"
 #include "message.h"
 #include "prompt.h"
@@ -45,7 +44,6 @@ void cio_cleanup()
 // Clear some globally defined variables.
 static void _clear_globals_on_exit()
 {
-    clear_rays_on_exit();
     clear_zap_info_on_exit();
     destroy_abyss();
 }
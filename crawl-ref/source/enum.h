@@ -4769,6 +4769,7 @@ enum uncancellable_type
 enum seed_type
 {
     SEED_PASSIVE_MAP,          // determinist magic mapping
+    SEED_LEVELGEN,             // per-level RNG streams for level generation
     NUM_SEEDS
 };
 
@@ -120,6 +120,12 @@ struct crawl_environment
     // Mapping mid->mindex until the transition is finished.
     map<mid_t, unsigned short> mid_cache;
 
+    // The slots of mons that may hold a live monster, in ascending order,
+    // so monster iterators can skip the empty ones. Maintained by
+    // mons_slot_used()/mons_slot_unused(); it may also list some slots
+    // whose monster has died but not yet been cleaned up.
+    vector<int> mons_used;
+
     // Things to happen when the current attack/etc finishes.
     vector<final_effect *> final_effects;
 
@@ -786,20 +786,44 @@ public:
     { return property_at(c, type, string(key)); }
     void clear();
 
+    // Markers (or their positions) with a non-empty value for key, equal
+    // to val if given, in the order of a scan of the map by rows.
+    vector<map_marker*> find_by_prop(const string &key, const string &val,
+                                     unsigned maxresults = 0);
+    vector<coord_def> find_positions_by_prop(const string &key,
+                                             const string &val,
+                                             unsigned maxresults = 0);
+
     void write(writer &) const;
     void read(reader &);
 
 private:
     typedef multimap<coord_def, map_marker *> dgn_marker_map;
     typedef pair<coord_def, map_marker *> dgn_pos_marker;
+    typedef vector<pair<map_marker *, string> > marker_prop_list;
 
     void init_from(const map_markers &);
     void unlink_marker(const map_marker *);
     void check_empty();
+    void invalidate_index();
+    const vector<map_marker *> &in_map_order();
+    const marker_prop_list &markers_with_prop(const string &key);
 
 private:
     dgn_marker_map markers;
     bool have_inactive_markers;
+
+    // Lazily built lookup structures, thrown away whenever a marker is
+    // added, removed or moved. prop_index only holds properties whose
+    // value is fixed for every marker (see map_marker::property_is_fixed).
+    vector<map_marker *> ordered;
+    bool ordered_valid;
+    // The markers of each type, in marker map order.
+    vector<vector<map_marker *>> by_type;
+    bool by_type_valid;
+    map<string, marker_prop_list> prop_index;
+    unsigned int prop_index_generation;
+    marker_prop_list prop_scratch;
 };
 
 class InvEntry;
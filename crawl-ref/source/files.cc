@@ -60,6 +60,7 @@
 #include "output.h"
 #include "place.h"
 #include "prompt.h"
+#include "random.h"
 #include "spl-summoning.h"
 #include "state.h"
 #include "stringutil.h"
@@ -86,8 +87,6 @@
 #define F_OK 0
 #endif
 
-static void _save_level(const level_id& lid);
-
 static bool _ghost_version_compatible(reader &ghost_reader);
 
 static bool _restore_tagged_chunk(package *save, const string name,
@@ -1165,7 +1164,20 @@ static void _make_level(dungeon_feature_type stair_taken,
                              dummy));
 
     _clear_env_map();
-    builder(true, stair_type);
+
+    // Levels in the connected dungeon draw from an RNG stream of their own,
+    // which depends only on the game and the level, not on what the player
+    // did before getting there.
+    const level_id lid = level_id::current();
+    if (is_connected_branch(lid))
+    {
+        const string place = lid.describe();
+        rng_stream levelgen_rng(you.game_seeds[SEED_LEVELGEN],
+                                hash32(place.data(), place.length()));
+        builder(true, stair_type);
+    }
+    else
+        builder(true, stair_type);
 
     const bool is_halloween = today_is_halloween();
 
@@ -1306,7 +1318,7 @@ bool load_level(dungeon_feature_type stair_taken, load_mode_type load_mode,
             if (env.level_state & LSTATE_DELETED)
                 delete_level(old_level), dprf("<lightmagenta>Deleting level.</lightmagenta>");
             else
-                _save_level(old_level);
+                save_level(old_level);
         }
 
         // The player is now between levels.
@@ -1425,7 +1437,7 @@ bool load_level(dungeon_feature_type stair_taken, load_mode_type load_mode,
 
     // Save the created/updated level out to disk:
     if (make_changes)
-        _save_level(level_id::current());
+        save_level(level_id::current());
 
     setup_environment_effects();
 
@@ -1536,7 +1548,7 @@ bool load_level(dungeon_feature_type stair_taken, load_mode_type load_mode,
     return just_created_level;
 }
 
-static void _save_level(const level_id& lid)
+void save_level(const level_id& lid)
 {
     travel_cache.get_level_info(lid).update();
 
@@ -1613,7 +1625,7 @@ static void _save_game_exit()
 
     // Must be exiting -- save level & goodbye!
     if (!you.entering_level)
-        _save_level(level_id::current());
+        save_level(level_id::current());
 
     clrscr();
 
@@ -2047,7 +2059,7 @@ void level_excursion::go_to(const level_id& next)
     {
         ever_changed_levels = true;
 
-        _save_level(level_id::current());
+        save_level(level_id::current());
         _load_level(next);
 
         LevelInfo &li = travel_cache.get_level_info(next);
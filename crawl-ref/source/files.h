@@ -66,6 +66,7 @@ class level_id;
 bool load_level(dungeon_feature_type stair_taken, load_mode_type load_mode,
                 const level_id& old_level);
 void delete_level(const level_id &level);
+void save_level(const level_id& lid);
 
 void save_game(bool leave_game, const char *bye = nullptr);
 
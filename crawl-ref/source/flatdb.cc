@@ -0,0 +1,388 @@
+/**
+ * @file
+ * @brief Immutable string database, mapped into memory for reading.
+ *
+ * File layout, all integers being native uint32_t:
+ *
+ *   header
+ *   displacements[num_buckets]
+ *   slots[num_slots]            -- entry index, or EMPTY_SLOT
+ *   entries[num_entries]        -- sorted by key
+ *   blob[blob_size]             -- the key and value strings
+ *
+ * A key hashes (with seed 0) to a bucket, whose displacement is the seed
+ * for a second hash that picks its slot. The writer searches for
+ * displacements that give every key a slot of its own.
+**/
+
+#include "AppHdr.h"
+
+#include "flatdb.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifndef TARGET_OS_WINDOWS
+#include <sys/mman.h>
+#endif
+#ifndef TARGET_COMPILER_VC
+#include <unistd.h>
+#endif
+
+#include "syscalls.h"
+
+#define FLAT_DB_MAGIC     "CRAWLFDB"
+#define FLAT_DB_VERSION   1
+#define FLAT_DB_BYTEORDER 0x01020304U
+#define EMPTY_SLOT        0xFFFFFFFFU
+
+struct flat_db::header
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t num_entries;
+    uint32_t num_buckets;
+    uint32_t num_slots;
+    uint32_t blob_size;
+};
+
+struct flat_db::entry
+{
+    uint32_t key_offset;
+    uint32_t key_len;
+    uint32_t value_offset;
+    uint32_t value_len;
+};
+
+static uint32_t _flat_hash(const char *s, size_t len, uint32_t seed)
+{
+    // FNV-1a, finished with murmur3's mixer so that nearby seeds give
+    // unrelated hashes.
+    uint32_t h = 2166136261U ^ seed;
+    for (size_t i = 0; i < len; ++i)
+        h = (h ^ (uint8_t)s[i]) * 16777619U;
+    h ^= h >> 16;
+    h *= 0x85ebca6bU;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35U;
+    h ^= h >> 16;
+    return h;
+}
+
+// ----------------------------------------------------------------------
+// flat_db
+// ----------------------------------------------------------------------
+
+flat_db::flat_db() : data(nullptr), data_size(0), mapped(false)
+{
+}
+
+flat_db::~flat_db()
+{
+    close();
+}
+
+bool flat_db::open(const string &filename)
+{
+    close();
+
+    int fd = open_u(filename.c_str(), O_RDONLY | O_BINARY, 0);
+    if (fd == -1)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) || st.st_size < (off_t)sizeof(header))
+    {
+        ::close(fd);
+        return false;
+    }
+    data_size = st.st_size;
+
+#ifndef TARGET_OS_WINDOWS
+    void *map = mmap(nullptr, data_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map != MAP_FAILED)
+    {
+        data = static_cast<const char *>(map);
+        mapped = true;
+    }
+#endif
+    if (!data)
+    {
+        // No mmap: read the whole thing in, which is still only one read.
+        char *buf = new char[data_size];
+        if (read(fd, buf, data_size) == (ssize_t)data_size)
+            data = buf;
+        else
+            delete[] buf;
+    }
+    ::close(fd);
+
+    if (!data)
+        return false;
+
+    const header &h = *head();
+    const uint64_t expected = sizeof(header)
+                              + 4 * ((uint64_t)h.num_buckets + h.num_slots)
+                              + sizeof(entry) * (uint64_t)h.num_entries
+                              + h.blob_size;
+    if (memcmp(h.magic, FLAT_DB_MAGIC, sizeof(h.magic))
+        || h.version != FLAT_DB_VERSION
+        || h.byte_order != FLAT_DB_BYTEORDER
+        || !h.num_buckets || !h.num_slots
+        || expected != data_size)
+    {
+        close();
+        return false;
+    }
+
+    return true;
+}
+
+void flat_db::close()
+{
+    if (!data)
+        return;
+
+#ifndef TARGET_OS_WINDOWS
+    if (mapped)
+        munmap(const_cast<char *>(data), data_size);
+    else
+#endif
+        delete[] data;
+
+    data = nullptr;
+    data_size = 0;
+    mapped = false;
+}
+
+const flat_db::header *flat_db::head() const
+{
+    return reinterpret_cast<const header *>(data);
+}
+
+const uint32_t *flat_db::displacements() const
+{
+    return reinterpret_cast<const uint32_t *>(head() + 1);
+}
+
+const uint32_t *flat_db::slots() const
+{
+    return displacements() + head()->num_buckets;
+}
+
+const flat_db::entry *flat_db::entries() const
+{
+    return reinterpret_cast<const entry *>(slots() + head()->num_slots);
+}
+
+string flat_db::blob_string(uint32_t offset, uint32_t len) const
+{
+    const header &h = *head();
+    if ((uint64_t)offset + len > h.blob_size)
+        return "";
+
+    const char *blob = data + data_size - h.blob_size;
+    return string(blob + offset, len);
+}
+
+const flat_db::entry *flat_db::find(const string &key) const
+{
+    if (!data)
+        return nullptr;
+
+    const header &h = *head();
+    if (!h.num_entries)
+        return nullptr;
+
+    const uint32_t bucket =
+        _flat_hash(key.data(), key.length(), 0) % h.num_buckets;
+    const uint32_t slot =
+        _flat_hash(key.data(), key.length(), displacements()[bucket])
+        % h.num_slots;
+    const uint32_t i = slots()[slot];
+    if (i >= h.num_entries)
+        return nullptr;
+
+    const entry &e = entries()[i];
+    const char *blob = data + data_size - h.blob_size;
+    if (e.key_len != key.length()
+        || (uint64_t)e.key_offset + e.key_len > h.blob_size
+        || memcmp(blob + e.key_offset, key.data(), e.key_len))
+    {
+        return nullptr;
+    }
+
+    return &e;
+}
+
+string flat_db::query(const string &key) const
+{
+    const entry *e = find(key);
+    return e ? blob_string(e->value_offset, e->value_len) : "";
+}
+
+bool flat_db::query(const string &key, const char *&value, size_t &len) const
+{
+    const entry *e = find(key);
+    if (!e || (uint64_t)e->value_offset + e->value_len > head()->blob_size)
+        return false;
+
+    value = data + data_size - head()->blob_size + e->value_offset;
+    len = e->value_len;
+    return true;
+}
+
+unsigned int flat_db::size() const
+{
+    return data ? head()->num_entries : 0;
+}
+
+string flat_db::key_at(unsigned int i) const
+{
+    ASSERT(i < size());
+    const entry &e = entries()[i];
+    return blob_string(e.key_offset, e.key_len);
+}
+
+string flat_db::value_at(unsigned int i) const
+{
+    ASSERT(i < size());
+    const entry &e = entries()[i];
+    return blob_string(e.value_offset, e.value_len);
+}
+
+// ----------------------------------------------------------------------
+// flat_db_writer
+// ----------------------------------------------------------------------
+
+void flat_db_writer::add(const string &key, const string &value)
+{
+    entries[key] = value;
+}
+
+// Find a displacement for every bucket such that all keys land in
+// different slots. Gives up (so the caller can add more slots) if some
+// bucket can't be placed.
+static bool _place_keys(const vector<vector<uint32_t>> &buckets,
+                        const vector<const string *> &keys,
+                        vector<uint32_t> &disp, vector<uint32_t> &slots)
+{
+    const uint32_t num_slots = slots.size();
+    fill(slots.begin(), slots.end(), EMPTY_SLOT);
+
+    // Place the biggest buckets first, while there's the most room.
+    vector<uint32_t> order(buckets.size());
+    for (uint32_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    stable_sort(order.begin(), order.end(),
+                [&buckets](uint32_t a, uint32_t b)
+                {
+                    return buckets[a].size() > buckets[b].size();
+                });
+
+    vector<uint32_t> placed;
+    for (uint32_t b : order)
+    {
+        const vector<uint32_t> &bucket = buckets[b];
+        if (bucket.empty())
+            break;
+
+        bool found = false;
+        for (uint32_t d = 1; d < 100000 && !found; ++d)
+        {
+            placed.clear();
+            for (uint32_t k : bucket)
+            {
+                const uint32_t s = _flat_hash(keys[k]->data(),
+                                              keys[k]->length(), d)
+                                   % num_slots;
+                if (slots[s] != EMPTY_SLOT
+                    || find(placed.begin(), placed.end(), s) != placed.end())
+                {
+                    break;
+                }
+                placed.push_back(s);
+            }
+
+            if (placed.size() == bucket.size())
+            {
+                for (uint32_t i = 0; i < bucket.size(); ++i)
+                    slots[placed[i]] = bucket[i];
+                disp[b] = d;
+                found = true;
+            }
+        }
+
+        if (!found)
+            return false;
+    }
+
+    return true;
+}
+
+bool flat_db_writer::write(const string &filename) const
+{
+    const uint32_t num_entries = entries.size();
+
+    vector<const string *> keys;
+    vector<flat_db::entry> ents;
+    string blob;
+    for (const auto &kv : entries)
+    {
+        flat_db::entry e;
+        e.key_offset = blob.length();
+        e.key_len = kv.first.length();
+        blob += kv.first;
+        e.value_offset = blob.length();
+        e.value_len = kv.second.length();
+        blob += kv.second;
+
+        keys.push_back(&kv.first);
+        ents.push_back(e);
+    }
+
+    const uint32_t num_buckets = num_entries / 4 + 1;
+    vector<vector<uint32_t>> buckets(num_buckets);
+    for (uint32_t i = 0; i < num_entries; ++i)
+    {
+        buckets[_flat_hash(keys[i]->data(), keys[i]->length(), 0)
+                % num_buckets].push_back(i);
+    }
+
+    vector<uint32_t> disp(num_buckets, 0);
+    vector<uint32_t> slots(num_entries + num_entries / 4 + 1);
+    while (!_place_keys(buckets, keys, disp, slots))
+        slots.resize(slots.size() + slots.size() / 8 + 1);
+
+    flat_db::header h;
+    memcpy(h.magic, FLAT_DB_MAGIC, sizeof(h.magic));
+    h.version = FLAT_DB_VERSION;
+    h.byte_order = FLAT_DB_BYTEORDER;
+    h.num_entries = num_entries;
+    h.num_buckets = num_buckets;
+    h.num_slots = slots.size();
+    h.blob_size = blob.length();
+
+    const string tmpname = filename + ".tmp";
+    FILE *f = fopen_u(tmpname.c_str(), "wb");
+    if (!f)
+        return false;
+
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1
+              && fwrite(disp.data(), 4, disp.size(), f) == disp.size()
+              && fwrite(slots.data(), 4, slots.size(), f) == slots.size()
+              && fwrite(ents.data(), sizeof(flat_db::entry), ents.size(), f)
+                 == ents.size()
+              && fwrite(blob.data(), 1, blob.length(), f) == blob.length();
+    ok = !fclose(f) && ok;
+
+    if (!ok || rename_u(tmpname.c_str(), filename.c_str()))
+    {
+        unlink_u(tmpname.c_str());
+        return false;
+    }
+
+    return true;
+}
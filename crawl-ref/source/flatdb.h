@@ -0,0 +1,74 @@
+/**
+ * @file
+ * @brief Immutable string database, mapped into memory for reading.
+**/
+
+#ifndef FLATDB_H
+#define FLATDB_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// A string-to-string database in a single file that is written once and
+// never changed. Readers map the file into memory: opening it parses
+// nothing, and every process reading the same file shares its pages.
+// Keys are found through a perfect hash built when the file is written,
+// so a lookup costs one probe.
+class flat_db
+{
+public:
+    flat_db();
+    ~flat_db();
+
+    bool open(const string &filename);
+    void close();
+    bool is_open() const { return data != nullptr; }
+
+    // The value for key, or "" if there is none.
+    string query(const string &key) const;
+    // The same without copying: sets value to point into the database,
+    // which stays valid until it is closed.
+    bool query(const string &key, const char *&value, size_t &len) const;
+
+    // Entries are numbered from 0 to size() - 1, in order of their keys.
+    unsigned int size() const;
+    string key_at(unsigned int i) const;
+    string value_at(unsigned int i) const;
+
+private:
+    struct header;
+    struct entry;
+
+    const header *head() const;
+    const uint32_t *displacements() const;
+    const uint32_t *slots() const;
+    const entry *entries() const;
+    const entry *find(const string &key) const;
+    string blob_string(uint32_t offset, uint32_t len) const;
+
+    const char *data;
+    size_t data_size;
+    bool mapped;
+
+    friend class flat_db_writer;
+
+    DISALLOW_COPY_AND_ASSIGN(flat_db);
+};
+
+// Collects entries for a flat_db, then writes out the file in one go.
+class flat_db_writer
+{
+public:
+    // Replaces any earlier value for the same key.
+    void add(const string &key, const string &value);
+
+    // Writes to a temporary file and renames it into place, so readers
+    // never see a partial database. Returns false on failure.
+    bool write(const string &filename) const;
+
+private:
+    map<string, string> entries;
+};
+
+#endif
@@ -67,7 +67,9 @@ static int newest_entry = -1;
 
 static FILE *_hs_open(const char *mode, const string &filename);
 static void  _hs_close(FILE *handle, const string &filename);
+static bool  _hs_read_line(FILE *scores, string &line);
 static bool  _hs_read(FILE *scores, scorefile_entry &dest);
+static int   _xlog_score(const string &line);
 static void  _hs_write(FILE *scores, scorefile_entry &entry);
 static time_t _parse_time(const string &st);
 static string _xlog_escape(const string &s);
@@ -98,81 +100,73 @@ void hiscores_new_entry(const scorefile_entry &ne)
 {
     unwind_bool score_update(crawl_state.updating_scores, true);
 
-    FILE *scores;
-    int i, total_entries;
-    bool inserted = false;
-
     // open highscore file (reading) -- nullptr is fatal!
     //
     // Opening as a+ instead of r+ to force an exclusive lock (see
     // hs_open) and to create the file if it's not there already.
-    scores = _hs_open("a+", _score_file_name());
+    FILE *scores = _hs_open("a+", _score_file_name());
     if (scores == nullptr)
         end(1, true, "failed to open score file for writing");
 
     // we're at the end of the file, seek back to beginning.
     fseek(scores, 0, SEEK_SET);
 
-    // read highscore file, inserting new entry at appropriate point,
+    // Find where the new entry goes. Only the scores are needed for that,
+    // so the entries aren't parsed; and everything before that point can
+    // stay as it is, so only the entries after it are kept.
+    const int score = ne.get_score();
+    vector<string> after;
+    long insert_pos = -1;
+    long pos = 0;
+    int i;
     for (i = 0; i < SCORE_FILE_ENTRIES; i++)
     {
-        hs_list[i].reset(new scorefile_entry);
-        if (_hs_read(scores, *hs_list[i]) == false)
+        pos = ftell(scores);
+        string line;
+        // Stop at anything scorefile_entry::parse() would reject.
+        if (!_hs_read_line(scores, line) || line[0] == ':')
             break;
 
-        // compare points..
-        if (!inserted && ne.get_score() >= hs_list[i]->get_score())
+        if (insert_pos == -1 && score >= _xlog_score(line))
         {
             newest_entry = i;           // for later printing
-            inserted = true;
-            // copy read entry to i+1th position
-            // Fixed a nasty overflow bug here -- Sharp
-            if (i+1 < SCORE_FILE_ENTRIES)
-            {
-                hs_list[i + 1] = move(hs_list[i]);
-                hs_list[i].reset(new scorefile_entry(ne));
-                i++;
-            }
-            else
-                *hs_list[i] = ne; // copy new entry to current position
+            insert_pos = pos;
         }
+
+        // The entry pushed off the end of the list is dropped.
+        if (insert_pos != -1 && i + 1 < SCORE_FILE_ENTRIES)
+            after.push_back(line);
     }
 
     // special case: lowest score, with room
-    if (!inserted && i < SCORE_FILE_ENTRIES)
+    if (insert_pos == -1 && i < SCORE_FILE_ENTRIES)
     {
         newest_entry = i;
-        inserted = true;
-        // copy new entry
-        hs_list[i].reset(new scorefile_entry(ne));
-        i++;
+        insert_pos = pos;
     }
 
     // If we've still not inserted it, it's not a highscore.
-    if (!inserted)
+    if (insert_pos == -1)
     {
         newest_entry = -1; // This might not be the first game
         _hs_close(scores, _score_file_name());
         return;
     }
 
-    total_entries = i;
-
     // The old code closed and reopened the score file, leading to a
     // race condition where one Crawl process could overwrite the
-    // other's highscore. Now we truncate and rewrite the file without
-    // closing it.
-    if (ftruncate(fileno(scores), 0))
+    // other's highscore. Now we truncate the file at the new entry
+    // and write the rest without closing it. Writes in a+ mode always go
+    // to the end of the file.
+    if (ftruncate(fileno(scores), insert_pos))
         end(1, true, "unable to truncate scorefile");
 
-    rewind(scores);
+    fseek(scores, 0, SEEK_END);
 
-    // write scorefile entries.
-    for (i = 0; i < total_entries; i++)
-    {
-        _hs_write(scores, *hs_list[i]);
-        hs_list[i].reset(nullptr);
-    }
+    scorefile_entry se = ne;
+    _hs_write(scores, se);
+    for (const string &line : after)
+        fputs(line.c_str(), scores);
 
     // close scorefile.
     _hs_close(scores, _score_file_name());
@@ -565,19 +559,38 @@ static void _hs_close(FILE *handle, const string &scores)
     lk_close(handle, scores);
 }
 
-static bool _hs_read(FILE *scores, scorefile_entry &dest)
+static bool _hs_read_line(FILE *scores, string &line)
 {
     char inbuf[1300];
     if (!scores || feof(scores))
         return false;
 
     memset(inbuf, 0, sizeof inbuf);
-    dest.reset();
 
     if (!fgets(inbuf, sizeof inbuf, scores))
         return false;
 
-    return dest.parse(inbuf);
+    line = inbuf;
+    return true;
+}
+
+static bool _hs_read(FILE *scores, scorefile_entry &dest)
+{
+    dest.reset();
+
+    string line;
+    return _hs_read_line(scores, line) && dest.parse(line);
+}
+
+// The score of an xlog line, without parsing the rest of it.
+static int _xlog_score(const string &line)
+{
+    // As with xlog_fields, the last of any repeated fields wins.
+    int score = 0;
+    for (const string &field : _xlog_split_fields(line))
+        if (starts_with(field, "sc="))
+            score = atoi(field.c_str() + 3);
+    return score;
 }
 
 static int _val_char(char digit)
@@ -683,6 +683,8 @@ static string _resolve_dir(const char* path, const char* suffix)
 
 void game_options::reset_options()
 {
+    ++generation;
+
     filename     = "unknown";
     basefilename = "unknown";
     line_num     = -1;
@@ -738,6 +740,8 @@ void game_options::reset_options()
     shared_dir = save_dir;
 #endif
 
+    level_gen_log_ms = 0;
+
     additional_macro_files.clear();
 
 #ifdef DGL_SIMPLE_MESSAGING
@@ -1719,6 +1723,7 @@ game_options::game_options()
     }
 #endif
     seed = 0;
+    generation = 0;
     reset_options();
 }
 
@@ -2494,6 +2499,8 @@ void game_options::read_option_line(const string &str, bool runscript)
     if (first_equals < 0)
         return;
 
+    ++generation;
+
     field = str.substr(first_equals + 1);
     field = expand_vars(field);
 
@@ -2895,6 +2902,7 @@ void game_options::read_option_line(const string &str, bool runscript)
     else if (key == "morgue_dir")
         morgue_dir = field;
 #endif
+    else INT_OPTION(level_gen_log_ms, 0, INT_MAX);
     else BOOL_OPTION(show_newturn_mark);
     else BOOL_OPTION(show_game_turns);
     else INT_OPTION(hp_warning, 0, 100);
@@ -4234,6 +4242,7 @@ enum commandline_option_type
     CLO_MAPSTAT,
     CLO_OBJSTAT,
     CLO_ITERATIONS,
+    CLO_JOBS,
     CLO_ARENA,
     CLO_DUMP_MAPS,
     CLO_TEST,
@@ -4271,7 +4280,7 @@ static const char *cmd_ops[] =
 {
     "scores", "name", "species", "background", "dir", "rc",
     "rcdir", "tscores", "vscores", "scorefile", "morgue", "macro",
-    "mapstat", "objstat", "iters", "arena", "dump-maps", "test", "script",
+    "mapstat", "objstat", "iters", "jobs", "arena", "dump-maps", "test", "script",
     "builddb", "help", "version", "seed", "save-version", "sprint",
     "extra-opt-first", "extra-opt-last", "sprint-map", "edit-save",
     "print-charset", "tutorial", "wizard", "explore", "no-save",
@@ -4706,6 +4715,7 @@ bool parse_args(int argc, char **argv, bool rc_only)
 
     SysEnv.rcdirs.clear();
     SysEnv.map_gen_iters = 0;
+    SysEnv.map_gen_jobs = 1;
 
     if (argc < 2)           // no args!
         return true;
@@ -4877,6 +4887,25 @@ bool parse_args(int argc, char **argv, bool rc_only)
 #endif
             break;
 
+        case CLO_JOBS:
+#ifdef DEBUG_STATISTICS
+            if (!next_is_param || !isadigit(*next_arg))
+            {
+                fprintf(stderr, "Integer argument required for -%s\n", arg);
+                end(1);
+            }
+            else
+            {
+                SysEnv.map_gen_jobs = max(1, atoi(next_arg));
+                nextUsed = true;
+            }
+#else
+            fprintf(stderr, "mapstat and objstat are available only in "
+                    "DEBUG_STATISTICS builds.\n");
+            end(1);
+#endif
+            break;
+
         case CLO_ARENA:
             if (!rc_only)
             {
@@ -20,11 +20,15 @@
 #include "mon-act.h"
 #include "mon-death.h"
 #include "mon-poly.h"
+#include "package.h"
 #include "religion.h"
 #include "stairs.h"
 #include "state.h"
 #include "stringutil.h"
+#include "tags.h"
+#include "terrain.h"
 #include "tileview.h"
+#include "unwind.h"
 #include "view.h"
 #include "wiz-dgn.h"
 
@@ -103,6 +107,29 @@ LUAFN(debug_generate_level)
     return 0;
 }
 
+// Usage: save_level(<in_memory>)
+// Saves the current level into a scratch package, the same way a level
+// change does, and returns the number of bytes written. If <in_memory> is
+// true, the level is only marshalled into a buffer and never compressed.
+// Meant for benchmarking the save path (see test/big/save_level_bench.lua).
+LUAFN(debug_save_level)
+{
+    if (lua_toboolean(ls, 1))
+    {
+        vector<unsigned char> buf;
+        writer th(&buf);
+        tag_write(TAG_LEVEL, th);
+        PLUARET(number, buf.size());
+    }
+
+    package scratch;
+    {
+        unwind_var<package*> save(you.save, &scratch);
+        save_level(level_id::current());
+    }
+    PLUARET(number, scratch.get_size());
+}
+
 LUAFN(debug_reveal_mimics)
 {
     for (rectangle_iterator ri(1); ri; ++ri)
@@ -117,6 +144,46 @@ LUAFN(debug_los_changed)
     return 0;
 }
 
+// Usage: losight(<iterations>)
+// Computes LOS from every non-solid cell of the level <iterations> times
+// (default 1), and returns the number of losight() calls made. Meant for
+// benchmarking the LOS code (see test/big/los_bench.lua).
+LUAFN(debug_losight)
+{
+    const int niters = lua_isnumber(ls, 1) ? lua_tointeger(ls, 1) : 1;
+    los_grid sh;
+    int calls = 0;
+    for (int i = 0; i < niters; ++i)
+        for (rectangle_iterator ri(1); ri; ++ri)
+        {
+            if (cell_is_solid(*ri))
+                continue;
+            losight(sh, *ri);
+            ++calls;
+        }
+    PLUARET(number, calls);
+}
+
+// Usage: updates, cells, full_repaints = console_output()
+// Returns the console's running totals of screen refreshes, cells sent to
+// the terminal, and full repaints; all 0 in local tiles. Cells are only
+// counted from the first call on, so call once before measuring, then take
+// differences between calls to measure the output of a turn or an action.
+LUAFN(debug_console_output)
+{
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+    const console_output_stats &stats = get_console_output_stats();
+    lua_pushnumber(ls, stats.updates);
+    lua_pushnumber(ls, stats.cells);
+    lua_pushnumber(ls, stats.full_repaints);
+#else
+    lua_pushnumber(ls, 0);
+    lua_pushnumber(ls, 0);
+    lua_pushnumber(ls, 0);
+#endif
+    return 3;
+}
+
 LUAFN(debug_dump_map)
 {
     const int pos = lua_isuserdata(ls, 1) ? 2 : 1;
@@ -376,9 +443,12 @@ const struct luaL_reg debug_dlib[] =
 { "up_stairs", debug_up_stairs },
 { "flush_map_memory", debug_flush_map_memory },
 { "generate_level", debug_generate_level },
+{ "save_level", debug_save_level },
 { "reveal_mimics", debug_reveal_mimics },
 { "los_changed", debug_los_changed },
+{ "losight", debug_losight },
 { "dump_map", debug_dump_map },
+{ "console_output", debug_console_output },
 { "test_explore", _debug_test_explore },
 { "bouncy_beam", debug_bouncy_beam },
 { "cull_monsters", debug_cull_monsters},
@@ -66,6 +66,13 @@ static int curs_bg_attr(int col);
 
 static bool cursor_is_enabled = true;
 
+static console_output_stats output_stats;
+// Comparing cells is slow, so only do it once someone has asked for stats.
+static bool count_output_cells = false;
+// Set when the next refresh will clear the terminal and repaint it all.
+static bool full_repaint_pending = false;
+static void _refresh_screen();
+
 static unsigned int convert_to_curses_attr(int chattr)
 {
     switch (chattr & CHATTR_ATTRMASK)
@@ -225,7 +232,7 @@ int getchk()
     wint_t c;
 
 #ifdef USE_TILE_WEB
-    refresh();
+    _refresh_screen();
 
     tiles.redraw();
     tiles.await_input(c, true);
@@ -234,6 +241,9 @@ int getchk()
         return c;
 #endif
 
+    // get_wch() would refresh the screen anyway, but do it here so that
+    // the output is counted.
+    _refresh_screen();
     switch (get_wch(&c))
     {
     case ERR:
@@ -440,8 +450,10 @@ void console_startup()
 
     scrollok(stdscr, FALSE);
 
-    // Must call refresh() for ncurses to update COLS and LINES.
-    refresh();
+    // Must call refresh() for ncurses to update COLS and LINES. This is
+    // also how we come back from a suspend or resize, so repaint it all.
+    force_full_repaint();
+    _refresh_screen();
     crawl_view.init_geometry();
 
     set_mouse_enabled(false);
@@ -509,9 +521,13 @@ void puttext(int x1, int y1, const crawl_view_buffer &vbuf)
     for (int y = 0; y < size.y; ++y)
     {
         cgotoxy(x1, y1 + y);
+        // Most of a row is in a few colours, so only switch when needed.
+        int colour = -1;
         for (int x = 0; x < size.x; ++x)
         {
-            put_colour_ch(cell->colour, cell->glyph);
+            if (cell->colour != colour)
+                textcolour(colour = cell->colour);
+            putwch(cell->glyph);
             cell++;
         }
     }
@@ -525,7 +541,7 @@ void puttext(int x1, int y1, const crawl_view_buffer &vbuf)
 // C++ string class.  -- bwr
 void update_screen()
 {
-    refresh();
+    _refresh_screen();
 
 #ifdef USE_TILE_WEB
     tiles.set_need_redraw();
@@ -562,10 +578,22 @@ void clrscr()
 {
     textcolour(LIGHTGREY);
     textbackground(BLACK);
-    clear();
+    // Only blank curses' copy of the screen: the next refresh then sends
+    // just the cells that end up different from what is already shown,
+    // rather than clearing the terminal and repainting everything.
+    erase();
 #ifdef DGAMELAUNCH
-    printf("%s", DGL_CLEAR_SCREEN);
-    fflush(stdout);
+    // ttyplay starts playback from the last clear screen sequence, so
+    // send a real one now and then.
+    static time_t last_dgl_clear = 0;
+    const time_t now = time(nullptr);
+    if (now - last_dgl_clear >= DGL_CLEAR_INTERVAL)
+    {
+        last_dgl_clear = now;
+        printf("%s", DGL_CLEAR_SCREEN);
+        fflush(stdout);
+        force_full_repaint();
+    }
 #endif
 
 #ifdef USE_TILE_WEB
@@ -763,6 +791,57 @@ static inline bool valid_char(const cchar_t &c)
     return *c.chars;
 }
 
+// Refresh the screen, counting how many cells it has to send.
+static void _refresh_screen()
+{
+    output_stats.updates++;
+    if (full_repaint_pending)
+    {
+        full_repaint_pending = false;
+        output_stats.full_repaints++;
+        output_stats.cells += LINES * COLS;
+    }
+    else if (count_output_cells)
+    {
+        // curscr holds what the terminal is showing; refresh() sends the
+        // cells in touched lines of stdscr that differ from it. Reading
+        // the cells moves the windows' cursors, so put them back after.
+        int cury, curx, physy, physx;
+        getyx(stdscr, cury, curx);
+        getyx(curscr, physy, physx);
+        for (int y = 0; y < LINES; ++y)
+        {
+            if (!is_linetouched(stdscr, y))
+                continue;
+
+            for (int x = 0; x < COLS; ++x)
+            {
+                cchar_t want, have;
+                (void)mvwin_wch(stdscr, y, x, &want);
+                (void)mvwin_wch(curscr, y, x, &have);
+                if (!(want == have))
+                    output_stats.cells++;
+            }
+        }
+        wmove(curscr, physy, physx);
+        move(cury, curx);
+    }
+
+    refresh();
+}
+
+void force_full_repaint()
+{
+    clearok(stdscr, TRUE);
+    full_repaint_pending = true;
+}
+
+const console_output_stats &get_console_output_stats()
+{
+    count_output_cells = true;
+    return output_stats;
+}
+
 static inline void write_char_at(int y, int x, const cchar_t &ch)
 {
     move(y, x);
@@ -834,7 +913,7 @@ void delay(unsigned int time)
     }
 #endif
 
-    refresh();
+    _refresh_screen();
     if (time)
         usleep(time * 1000);
 }
@@ -13,6 +13,20 @@
 
 void fakecursorxy(int x, int y);
 
+// Makes the next screen update clear the terminal and repaint all of it,
+// instead of sending only what changed.
+void force_full_repaint();
+
+// What the console has sent to the terminal so far.
+struct console_output_stats
+{
+    uint64_t updates;       // screen refreshes
+    uint64_t cells;         // cells that had changed and were sent
+    uint64_t full_repaints; // refreshes that repainted the whole terminal
+};
+// Cells in partial refreshes are only counted after the first call.
+const console_output_stats &get_console_output_stats();
+
 #ifdef USE_TILE_WEB
 bool is_tiles();
 #else
@@ -68,27 +68,98 @@ struct los_ray;
 static vector<los_ray> fullrays;
 static vector<coord_def> ray_coords;
 
+// An upper bound on the number of minimal cellrays, used to size the
+// ray sets below at compile time. With LOS_MAX_RANGE 7 there are 277;
+// _create_blockrays() checks that the bound holds.
+#define LOS_MAX_CELLRAYS (5 * (LOS_MAX_RANGE+1) * (LOS_MAX_RANGE+1))
+
+// A fixed-size set of minimal cellrays. The word loops have constant
+// trip counts and aligned operands, so the compiler can unroll and
+// vectorise them; that's where losight() spends most of its time.
+struct alignas(32) los_rays
+{
+    static const int NWORDS = (LOS_MAX_CELLRAYS + 63) / 64;
+    uint64_t words[NWORDS];
+
+    void reset()
+    {
+        for (int w = 0; w < NWORDS; ++w)
+            words[w] = 0;
+    }
+
+    bool get(int i) const
+    {
+        return words[i / 64] & (uint64_t(1) << (i % 64));
+    }
+
+    void set(int i)
+    {
+        words[i / 64] |= uint64_t(1) << (i % 64);
+    }
+
+    los_rays& operator|=(const los_rays& other)
+    {
+        for (int w = 0; w < NWORDS; ++w)
+            words[w] |= other.words[w];
+        return *this;
+    }
+
+    // *this |= a & b, without a temporary.
+    void or_and(const los_rays& a, const los_rays& b)
+    {
+        for (int w = 0; w < NWORDS; ++w)
+            words[w] |= a.words[w] & b.words[w];
+    }
+
+    bool any() const
+    {
+        uint64_t acc = 0;
+        for (int w = 0; w < NWORDS; ++w)
+            acc |= words[w];
+        return acc;
+    }
+
+    bool all() const
+    {
+        uint64_t acc = ~uint64_t(0);
+        for (int w = 0; w < NWORDS; ++w)
+            acc &= words[w];
+        return acc == ~uint64_t(0);
+    }
+};
+
+// Index of the lowest set bit; w must be non-zero.
+static inline int _lowest_bit(uint64_t w)
+{
+#ifdef __GNUC__
+    return __builtin_ctzll(w);
+#else
+    int i = 0;
+    for (; !(w & 1); w >>= 1)
+        ++i;
+    return i;
+#endif
+}
+
 // These store all unique minimal cellrays. For each i,
 // cellray i ends in cellray_ends[i] and passes through
 // thoses cells p that have blockrays(p)[i] set. In other
 // words, blockrays(p)[i] is set iff an opaque cell p blocks
 // the cellray with index i.
 static vector<coord_def> cellray_ends;
-typedef FixedArray<bit_vector*, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> blockrays_t;
+typedef FixedArray<los_rays, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> blockrays_t;
 static blockrays_t blockrays;
 
+// The padding bits past the last minimal cellray. losight() starts
+// with these marked dead, so that it never has to mask them out.
+static los_rays unused_rays;
+
 // We also store the minimal cellrays by target position
 // for efficient retrieval by find_ray.
 // XXX: Consider condensing this representation.
 struct cellray;
 static FixedArray<vector<cellray>, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> min_cellrays;
 
-// Temporary arrays used in losight() to track which rays
-// are blocked or have seen a smoke cloud.
-// Allocated when doing the precomputations.
-static bit_vector *dead_rays     = nullptr;
-static bit_vector *smoke_rays    = nullptr;
-
 class quadrant_iterator : public rectangle_iterator
 {
 public:
@@ -99,14 +170,6 @@ public:
     }
 };
 
-void clear_rays_on_exit()
-{
-    delete dead_rays;
-    delete smoke_rays;
-    for (quadrant_iterator qi; qi; ++qi)
-        delete blockrays(*qi);
-}
-
 // LOS radius.
 int los_radius = LOS_RADIUS;
 
@@ -382,7 +445,7 @@ static void _create_blockrays()
     // Cellrays are numbered according to the index of their end
     // cell in ray_coords.
     const int n_cellrays = ray_coords.size();
-    blockrays_t all_blockrays;
+    FixedArray<bit_vector*, LOS_MAX_RANGE+1, LOS_MAX_RANGE+1> all_blockrays;
     for (quadrant_iterator qi; qi; ++qi)
         all_blockrays(*qi) = new bit_vector(n_cellrays);
 
@@ -403,6 +466,11 @@ static void _create_blockrays()
     // Determine minimal cellrays and store their indices in ray_coords.
     vector<int> min_indices = _find_minimal_cellrays();
     const int n_min_rays    = min_indices.size();
+    if (n_min_rays > LOS_MAX_CELLRAYS)
+    {
+        die("too many minimal cellrays: %d > %d (raise LOS_MAX_CELLRAYS)",
+            n_min_rays, LOS_MAX_CELLRAYS);
+    }
     cellray_ends.resize(n_min_rays);
     for (int i = 0; i < n_min_rays; ++i)
         cellray_ends[i] = ray_coords[min_indices[i]];
@@ -410,21 +478,22 @@ static void _create_blockrays()
     // Compress blockrays accordingly.
     for (quadrant_iterator qi; qi; ++qi)
     {
-        blockrays(*qi) = new bit_vector(n_min_rays);
+        blockrays(*qi).reset();
         for (int i = 0; i < n_min_rays; ++i)
-        {
-            blockrays(*qi)->set(i, all_blockrays(*qi)
-                                   ->get(min_indices[i]));
-        }
+            if (all_blockrays(*qi)->get(min_indices[i]))
+                blockrays(*qi).set(i);
     }
 
+    unused_rays.reset();
+    for (int i = n_min_rays; i < LOS_MAX_CELLRAYS; ++i)
+        unused_rays.set(i);
+    for (int i = LOS_MAX_CELLRAYS; i < los_rays::NWORDS * 64; ++i)
+        unused_rays.set(i);
+
     // We can throw away all_blockrays now.
     for (quadrant_iterator qi; qi; ++qi)
         delete all_blockrays(*qi);
 
-    dead_rays  = new bit_vector(n_min_rays);
-    smoke_rays = new bit_vector(n_min_rays);
-
     dprf("Cellrays: %d Fullrays: %u Minimal cellrays: %u",
           n_cellrays, (unsigned int)fullrays.size(), n_min_rays);
 }
@@ -777,20 +846,20 @@ bool cell_see_cell_nocache(const coord_def& p1, const coord_def& p2)
 // fully for beam detection and such.
 // PERFORMANCE:
 // With reasonable values we have around 6000 cellrays, meaning
-// around 600Kb (75 KB) of data. This gets cut down to 700 cellrays
-// after removing duplicates. That means that we need to do
-// around 22*100*4 ~ 9,000 memory reads + writes per LOS call on a
-// 32-bit system. Not too bad.
+// around 600Kb (75 KB) of data. This gets cut down to under 300
+// cellrays after removing duplicates, so each ray set is a handful of
+// 64-bit words and a quadrant costs one short, unrolled OR loop per
+// opaque cell.
 // IMPROVEMENTS:
 // Smoke will now only block LOS after two cells of smoke. This is
 // done by updating with a second array.
 
 static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy)
 {
-    const unsigned int num_cellrays = cellray_ends.size();
-
-    dead_rays->reset();
-    smoke_rays->reset();
+    // Which rays are blocked or have seen a smoke cloud.
+    los_rays dead_rays = unused_rays;
+    los_rays smoke_rays;
+    smoke_rays.reset();
 
     for (quadrant_iterator qi; qi; ++qi)
     {
@@ -802,12 +871,15 @@ static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy
         {
         case OPC_OPAQUE:
             // Block the appropriate rays.
-            *dead_rays |= *blockrays(*qi);
+            dead_rays |= blockrays(*qi);
+            // Once every ray is blocked, nothing further out matters.
+            if (dead_rays.all())
+                return;
             break;
         case OPC_HALF:
             // Block rays which have already seen a cloud.
-            *dead_rays  |= (*smoke_rays & *blockrays(*qi));
-            *smoke_rays |= *blockrays(*qi);
+            dead_rays.or_and(smoke_rays, blockrays(*qi));
+            smoke_rays |= blockrays(*qi);
             break;
         default:
             break;
@@ -815,13 +887,12 @@ static void _losight_quadrant(los_grid& sh, const los_param& dat, int sx, int sy
     }
 
     // Ray calculation done. Now work out which cells in this
-    // quadrant are visible.
-    for (unsigned int rayidx = 0; rayidx < num_cellrays; ++rayidx)
+    // quadrant are visible: the ends of the rays that are still alive.
+    for (int w = 0; w < los_rays::NWORDS; ++w)
     {
-        // make the cells seen by this ray at this point visible
-        if (!dead_rays->get(rayidx))
+        for (uint64_t alive = ~dead_rays.words[w]; alive; alive &= alive - 1)
         {
-            // This ray is alive, thus the end cell is visible.
+            const int rayidx = w * 64 + _lowest_bit(alive);
             const coord_def p = coord_def(sx * cellray_ends[rayidx].x,
                                           sy * cellray_ends[rayidx].y);
             if (dat.los_bounds(p))
@@ -3,7 +3,6 @@
 #include "losglobal.h"
 
 #include "coord.h"
-#include "coordit.h"
 #include "libutil.h"
 #include "los_def.h"
 
@@ -17,6 +16,22 @@ typedef halflos_t globallos_t[GXM][GYM];
 
 static globallos_t globallos;
 
+// Invalidating doesn't clear anything: the half-LOS block of a cell is
+// only valid while its stamp equals globallos_generation, and a stale
+// block is cleared when it is next looked at.
+static uint32_t globallos_stamp[GXM][GYM];
+static uint32_t globallos_generation = 1;
+
+static halflos_t &_halflos_at(int x, int y)
+{
+    if (globallos_stamp[x][y] != globallos_generation)
+    {
+        memset(globallos[x][y], 0, sizeof(halflos_t));
+        globallos_stamp[x][y] = globallos_generation;
+    }
+    return globallos[x][y];
+}
+
 static losfield_t* _lookup_globallos(const coord_def& p, const coord_def& q)
 {
     COMPILE_CHECK(LOS_KNOWN * 2 <= sizeof(losfield_t) * 8);
@@ -28,9 +43,9 @@ static losfield_t* _lookup_globallos(const coord_def& p, const coord_def& q)
         return nullptr;
     // p < q iff p.x < q.x || p.x == q.x && p.y < q.y
     if (diff < coord_def(0, 0))
-        return &globallos[q.x][q.y][-diff.x + o_half_x][-diff.y + o_half_y];
+        return &_halflos_at(q.x, q.y)[-diff.x + o_half_x][-diff.y + o_half_y];
     else
-        return &globallos[p.x][p.y][ diff.x + o_half_x][ diff.y + o_half_y];
+        return &_halflos_at(p.x, p.y)[ diff.x + o_half_x][ diff.y + o_half_y];
 }
 
 static void _save_los(los_def* los, los_type l)
@@ -68,13 +83,17 @@ void invalidate_los_around(const coord_def& p)
     for (int y = y1; y <= y2; y++)
         for (int x = x1; x <= x2; x++)
             if (max(abs(p.x - x), abs(p.y - y)) <= LOS_MAX_RANGE)
-                memset(globallos[x][y], 0, sizeof(halflos_t));
+                globallos_stamp[x][y] = 0;
 }
 
 void invalidate_los()
 {
-    for (rectangle_iterator ri(0); ri; ++ri)
-        memset(globallos[ri->x][ri->y], 0, sizeof(halflos_t));
+    // Stamps are never 0, so after wrapping around every block is stale.
+    if (!++globallos_generation)
+    {
+        memset(globallos_stamp, 0, sizeof(globallos_stamp));
+        globallos_generation = 1;
+    }
 }
 
 static void _update_globallos_at(const coord_def& p, los_type l)
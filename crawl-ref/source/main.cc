@@ -551,6 +551,9 @@ static void _show_commandline_options_help()
     puts("      Defaults to entire dungeon; same level syntax as -mapstat.");
     puts("  -iters <num>        For -mapstat and -objstat, set the number of "
          "iterations");
+    puts("  -jobs <num>         For -mapstat and -objstat, split the "
+         "iterations between");
+    puts("                      <num> worker processes");
 #endif
     puts("");
     puts("Miscellaneous options:");
@@ -2230,7 +2233,14 @@ void process_command(command_type cmd)
 #endif
 
         // Game commands.
-    case CMD_REDRAW_SCREEN: redraw_screen(); break;
+    case CMD_REDRAW_SCREEN:
+#if defined(UNIX) && !defined(USE_TILE_LOCAL)
+        // Screen clears only repaint what changed, which doesn't help if
+        // something else has scribbled on the terminal.
+        force_full_repaint();
+#endif
+        redraw_screen();
+        break;
 
 #ifdef USE_UNIX_SIGNALS
     case CMD_SUSPEND_GAME:
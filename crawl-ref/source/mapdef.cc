@@ -23,6 +23,7 @@
 #include "decks.h"
 #include "describe.h"
 #include "dgn-height.h"
+#include "dgn-profile.h"
 #include "dungeon.h"
 #include "end.h"
 #include "english.h"
@@ -2429,13 +2430,15 @@ void map_def::load()
     if (!index_only)
         return;
 
-    const string descache_base = get_descache_path(cache_name, "");
-    file_lock deslock(descache_base + ".lk", "rb", false);
-    const string loadfile = descache_base + ".dsc";
-
-    reader inf(loadfile, TAG_MINOR_VERSION);
-    if (!inf.valid())
+    const char *data;
+    size_t len;
+    if (!map_cache_entry(cache_name, ".dsc", data, len)
+        || cache_offset >= (long)len)
+    {
         throw map_load_exception(name);
+    }
+
+    reader inf(data, len, TAG_MINOR_VERSION);
     inf.advance(cache_offset);
     read_full(inf, true);
 
@@ -2535,6 +2538,7 @@ void map_def::set_file(const string &s)
 
 string map_def::run_lua(bool run_main)
 {
+    dgn_phase_timer timer(DGN_PHASE_LUA);
     dlua_set_map mset(this);
 
     int err = prelude.load(dlua);
@@ -2592,6 +2596,7 @@ void map_def::copy_hooks_from(const map_def &other_map, const string &hook_name)
 // no errors occurred while running hooks.
 bool map_def::run_hook(const string &hook_name, bool die_on_lua_error)
 {
+    dgn_phase_timer timer(DGN_PHASE_LUA);
     const dlua_set_map mset(this);
     if (!dlua.callfn("dgn_map_run_hook", "s", hook_name.c_str()))
     {
@@ -2618,6 +2623,7 @@ bool map_def::run_postplace_hook(bool die_on_lua_error)
 bool map_def::test_lua_boolchunk(dlua_chunk &chunk, bool defval,
                                  bool die_on_lua_error)
 {
+    dgn_phase_timer timer(DGN_PHASE_LUA);
     bool result = defval;
     dlua_set_map mset(this);
 
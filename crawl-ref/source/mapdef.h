@@ -46,8 +46,8 @@ static const int INVALID_HEIGHT = -31999;
 
 static const int BRANCH_END = 100;
 
-// Exception thrown when a map cannot be loaded from its .dsc file
-// because the .dsc file has changed under it.
+// Exception thrown when a map cannot be loaded from the map cache
+// because its compiled des file has changed under it.
 class map_load_exception : public exception
 {
 public:
@@ -10,6 +10,7 @@
 #include <algorithm>
 
 #include "cluautil.h"
+#include "coord.h"
 #include "coordit.h"
 #include "dlua.h"
 #include "end.h"
@@ -82,6 +83,11 @@ string map_marker::property(const string &pname) const
     return "";
 }
 
+bool map_marker::property_is_fixed(const string &pname) const
+{
+    return true;
+}
+
 map_marker *map_marker::read_marker(reader &inf)
 {
     const map_marker_type mtype =
@@ -169,12 +175,14 @@ string map_feature_marker::debug_describe() const
 // map_lua_marker
 
 map_lua_marker::map_lua_marker()
-    : map_marker(MAT_LUA_MARKER, coord_def()), initialised(false)
+    : map_marker(MAT_LUA_MARKER, coord_def()), initialised(false),
+      immutable_props_loaded(false), all_props_immutable(false)
 {
 }
 
 map_lua_marker::map_lua_marker(const lua_datum &fn)
-    : map_marker(MAT_LUA_MARKER, coord_def())
+    : map_marker(MAT_LUA_MARKER, coord_def()), initialised(false),
+      immutable_props_loaded(false), all_props_immutable(false)
 {
     lua_stack_cleaner clean(dlua);
     fn.push();
@@ -186,7 +194,8 @@ map_lua_marker::map_lua_marker(const lua_datum &fn)
 
 map_lua_marker::map_lua_marker(const string &s, const string &,
                                bool mapdef_marker)
-    : map_marker(MAT_LUA_MARKER, coord_def()), initialised(false)
+    : map_marker(MAT_LUA_MARKER, coord_def()), initialised(false),
+      immutable_props_loaded(false), all_props_immutable(false)
 {
     lua_stack_cleaner clean(dlua);
     if (mapdef_marker)
@@ -232,6 +241,9 @@ void map_lua_marker::check_register_table()
     // Got a table. Save it in the registry.
     marker_table.reset(new lua_datum(dlua));
     initialised = true;
+
+    immutable_props_loaded = false;
+    prop_cache.clear();
 }
 
 bool map_lua_marker::get_table() const
@@ -382,8 +394,49 @@ string map_lua_marker::debug_describe() const
     return call_str_fn("describe");
 }
 
+void map_lua_marker::load_immutable_props() const
+{
+    if (immutable_props_loaded)
+        return;
+    immutable_props_loaded = true;
+    all_props_immutable = false;
+    immutable_props.clear();
+
+    lua_stack_cleaner cln(dlua);
+    if (!get_table())
+        return;
+
+    lua_getfield(dlua, -1, "immutable_props");
+    if (lua_isboolean(dlua, -1))
+        all_props_immutable = lua_toboolean(dlua, -1);
+    else if (lua_istable(dlua, -1))
+    {
+        lua_pushnil(dlua);
+        while (lua_next(dlua, -2))
+        {
+            if (lua_type(dlua, -2) == LUA_TSTRING && lua_toboolean(dlua, -1))
+                immutable_props.insert(lua_tostring(dlua, -2));
+            lua_pop(dlua, 1);
+        }
+    }
+}
+
+bool map_lua_marker::property_is_fixed(const string &pname) const
+{
+    load_immutable_props();
+    return all_props_immutable || immutable_props.count(pname);
+}
+
 string map_lua_marker::property(const string &pname) const
 {
+    const bool fixed = property_is_fixed(pname);
+    if (fixed)
+    {
+        auto cached = prop_cache.find(pname);
+        if (cached != prop_cache.end())
+            return cached->second;
+    }
+
     lua_stack_cleaner cln(dlua);
     push_fn_args("property");
     lua_pushstring(dlua, pname.c_str());
@@ -397,6 +450,8 @@ string map_lua_marker::property(const string &pname) const
     string result;
     if (lua_isstring(dlua, -1))
         result = lua_tostring(dlua, -1);
+    if (fixed)
+        prop_cache[pname] = result;
     return result;
 }
 
@@ -531,10 +586,15 @@ string map_wiz_props_marker::property(const string &pname) const
     return lookup(properties, pname, "");
 }
 
+// Bumped whenever a marker property changes under map_markers' feet, to
+// throw away its property index.
+static unsigned int _marker_props_changed = 0;
+
 string map_wiz_props_marker::set_property(const string &key, const string &val)
 {
     string old_val = properties[key];
     properties[key] = val;
+    ++_marker_props_changed;
     return old_val;
 }
 
@@ -945,12 +1005,15 @@ string map_position_marker::debug_describe() const
 //////////////////////////////////////////////////////////////////////////
 // Map markers in env.
 
-map_markers::map_markers() : markers(), have_inactive_markers(false)
+map_markers::map_markers()
+  : markers(), have_inactive_markers(false), ordered_valid(false),
+    by_type_valid(false), prop_index_generation(0)
 {
 }
 
 map_markers::map_markers(const map_markers &c)
-  : markers(), have_inactive_markers(false)
+  : markers(), have_inactive_markers(false), ordered_valid(false),
+    by_type_valid(false), prop_index_generation(0)
 {
     init_from(c);
 }
@@ -1021,10 +1084,12 @@ void map_markers::add(map_marker *marker)
 {
     markers.insert(dgn_pos_marker(marker->pos, marker));
     have_inactive_markers = true;
+    invalidate_index();
 }
 
 void map_markers::unlink_marker(const map_marker *marker)
 {
+    invalidate_index();
     auto els = markers.equal_range(marker->pos);
     for (auto i = els.first; i != els.second; ++i)
     {
@@ -1052,6 +1117,7 @@ void map_markers::remove(map_marker *marker)
 void map_markers::remove_markers_at(const coord_def &c,
                                     map_marker_type type)
 {
+    invalidate_index();
     auto els = markers.equal_range(c);
     for (auto i = els.first; i != els.second;)
     {
@@ -1086,6 +1152,7 @@ map_marker *map_markers::find(map_marker_type type)
 void map_markers::move(const coord_def &from, const coord_def &to)
 {
     unwind_bool inactive(have_inactive_markers);
+    invalidate_index();
     auto els = markers.equal_range(from);
 
     list<map_marker*> tmarkers;
@@ -1113,12 +1180,23 @@ void map_markers::move_marker(map_marker *marker, const coord_def &to)
 
 vector<map_marker*> map_markers::get_all(map_marker_type mat)
 {
-    vector<map_marker*> rmarkers;
-    for (const auto &entry : markers)
+    if (mat != MAT_ANY)
     {
-        if (mat == MAT_ANY || entry.second->get_type() == mat)
-            rmarkers.push_back(entry.second);
+        // The timed effects ask for their markers by type every turn,
+        // so keep them sorted by type rather than scanning every marker.
+        if (!by_type_valid)
+        {
+            by_type.assign(NUM_MAP_MARKER_TYPES, vector<map_marker*>());
+            for (const auto &entry : markers)
+                by_type[entry.second->get_type()].push_back(entry.second);
+            by_type_valid = true;
+        }
+        return by_type[mat];
     }
+
+    vector<map_marker*> rmarkers;
+    for (const auto &entry : markers)
+        rmarkers.push_back(entry.second);
     return rmarkers;
 }
 
@@ -1165,9 +1243,113 @@ void map_markers::clear()
     for (auto &entry : markers)
         delete entry.second;
     markers.clear();
+    invalidate_index();
     check_empty();
 }
 
+void map_markers::invalidate_index()
+{
+    ordered.clear();
+    ordered_valid = false;
+    by_type.clear();
+    by_type_valid = false;
+    prop_index.clear();
+}
+
+// The markers on the map, in the order a scan by rows would meet them.
+// Markers at the same position keep their order in the marker map.
+const vector<map_marker*> &map_markers::in_map_order()
+{
+    if (ordered_valid)
+        return ordered;
+
+    ordered.clear();
+    for (const auto &entry : markers)
+        if (map_bounds(entry.first))
+            ordered.push_back(entry.second);
+    stable_sort(ordered.begin(), ordered.end(),
+                [](const map_marker *a, const map_marker *b)
+                {
+                    return a->pos.y < b->pos.y
+                           || a->pos.y == b->pos.y && a->pos.x < b->pos.x;
+                });
+    ordered_valid = true;
+    return ordered;
+}
+
+// Every marker with a non-empty value for key, with that value, in map
+// order. Properties that are fixed for all markers are kept in
+// prop_index; the rest are looked up afresh each time.
+const map_markers::marker_prop_list &
+map_markers::markers_with_prop(const string &key)
+{
+    if (prop_index_generation != _marker_props_changed)
+    {
+        prop_index.clear();
+        prop_index_generation = _marker_props_changed;
+    }
+
+    auto cached = prop_index.find(key);
+    if (cached != prop_index.end())
+        return cached->second;
+
+    // Copy the list, as a Lua property function could remove markers.
+    const vector<map_marker*> order = in_map_order();
+    marker_prop_list found;
+    bool fixed = true;
+    for (map_marker *marker : order)
+    {
+        fixed = fixed && marker->property_is_fixed(key);
+        string value = marker->property(key);
+        if (!value.empty())
+            found.emplace_back(marker, std::move(value));
+    }
+
+    if (fixed && ordered_valid)
+        return prop_index[key] = std::move(found);
+
+    prop_scratch = std::move(found);
+    return prop_scratch;
+}
+
+vector<map_marker*> map_markers::find_by_prop(const string &key,
+                                              const string &val,
+                                              unsigned maxresults)
+{
+    vector<map_marker*> found;
+    for (const auto &entry : markers_with_prop(key))
+    {
+        if (!val.empty() && entry.second != val)
+            continue;
+        found.push_back(entry.first);
+        if (maxresults && found.size() >= maxresults)
+            break;
+    }
+    return found;
+}
+
+vector<coord_def> map_markers::find_positions_by_prop(const string &key,
+                                                      const string &val,
+                                                      unsigned maxresults)
+{
+    vector<coord_def> found;
+    coord_def last(-1, -1);
+    for (const auto &entry : markers_with_prop(key))
+    {
+        // Only the first marker with a value counts at each position,
+        // as with property_at().
+        if (entry.first->pos == last)
+            continue;
+        last = entry.first->pos;
+        if (!val.empty() && entry.second != val)
+            continue;
+        found.push_back(last);
+        if (maxresults && found.size() >= maxresults)
+            break;
+    }
+    return found;
+}
+
 static const long MARKERS_COOKY = 0x17742C32;
 void map_markers::write(writer &outf) const
 {
@@ -1231,39 +1413,14 @@ vector<coord_def> find_marker_positions_by_prop(const string &prop,
                                                 const string &expected,
                                                 unsigned maxresults)
 {
-    vector<coord_def> marker_positions;
-    for (rectangle_iterator i(0, 0); i; ++i)
-    {
-        const string value = env.markers.property_at(*i, MAT_ANY, prop);
-        if (!value.empty() && (expected.empty() || value == expected))
-        {
-            marker_positions.push_back(*i);
-            if (maxresults && marker_positions.size() >= maxresults)
-                return marker_positions;
-        }
-    }
-    return marker_positions;
+    return env.markers.find_positions_by_prop(prop, expected, maxresults);
 }
 
 vector<map_marker*> find_markers_by_prop(const string &prop,
                                          const string &expected,
                                          unsigned maxresults)
 {
-    vector<map_marker*> markers;
-    for (rectangle_iterator pos(0, 0); pos; ++pos)
-    {
-        for (map_marker *mark : env.markers.get_markers_at(*pos))
-        {
-            const string value(mark->property(prop));
-            if (!value.empty() && (expected.empty() || value == expected))
-            {
-                markers.push_back(mark);
-                if (maxresults && markers.size() >= maxresults)
-                    return markers;
-            }
-        }
-    }
-    return markers;
+    return env.markers.find_by_prop(prop, expected, maxresults);
 }
 
 ///////////////////////////////////////////////////////////////////
@@ -8,6 +8,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -46,6 +47,10 @@ public:
     virtual void read(reader &);
     virtual string debug_describe() const = 0;
     virtual string property(const string &pname) const;
+    // Whether property(pname) always returns the same value, so that
+    // map_markers may index it. Subclasses whose properties can change
+    // must override this, or invalidate the index when they change.
+    virtual bool property_is_fixed(const string &pname) const;
 
     static map_marker *read_marker(reader &);
     static map_marker *parse_marker(const string &text,
@@ -259,6 +264,7 @@ public:
     map_marker *clone() const;
     string debug_describe() const;
     string property(const string &pname) const;
+    bool property_is_fixed(const string &pname) const;
 
     bool notify_dgn_event(const dgn_event &e);
 
@@ -270,8 +276,17 @@ private:
     bool initialised;
     unique_ptr<lua_datum> marker_table;
 
+    // Properties the marker's Lua class declares immutable, through its
+    // immutable_props field (true for all of them, or a set of names), and
+    // the values of those looked up so far.
+    mutable bool immutable_props_loaded;
+    mutable bool all_props_immutable;
+    mutable set<string> immutable_props;
+    mutable map<string, string> prop_cache;
+
 private:
     void check_register_table();
+    void load_immutable_props() const;
     bool get_table() const;
     void push_fn_args(const char *fn) const;
     bool callfn(const char *fn, bool warn_err = false, int args = -1) const;
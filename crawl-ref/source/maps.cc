@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <cstdlib>
 #include <cstring>
+#include <unordered_map>
 #include <sys/param.h>
 #include <sys/types.h>
 #ifndef TARGET_COMPILER_VC
@@ -24,6 +25,7 @@
 #include "end.h"
 #include "endianness.h"
 #include "files.h"
+#include "flatdb.h"
 #include "mapmark.h"
 #include "message.h"
 #include "state.h"
@@ -714,6 +716,124 @@ vector<string> find_map_matches(const string &name)
     return matches;
 }
 
+///////////////////////////////////////////////////////////////////////////
+// Map index
+//
+// Rather than checking every map in vdefs whenever a level wants a vault,
+// the lookups below work from short candidate lists: the maps carrying
+// each tag, and the maps usable at each place. Candidates are always in
+// vdefs order, so the choices made (and the RNG calls) are the same as
+// with a full scan.
+
+typedef vector<unsigned> vault_indices;
+
+// Each tag seen is given an id; maps_by_tag[id] lists the maps with it.
+static unordered_map<string, int> map_tag_ids;
+static vector<vault_indices> maps_by_tag;
+// How many of vdefs are covered by the tag index.
+static size_t map_tag_index_size = 0;
+
+// Maps whose DEPTH: or PLACE: matches a level, filled in on demand.
+// level_range matching depends on branch depths, so these are thrown
+// away if brdepth changes (as it can between games), or more maps are
+// loaded.
+static map<level_id, vault_indices> maps_by_depth;
+static map<level_id, vault_indices> maps_by_place;
+static FixedVector<int, NUM_BRANCHES> map_index_brdepth;
+static size_t map_level_index_size = 0;
+
+static void _clear_map_index()
+{
+    map_tag_ids.clear();
+    maps_by_tag.clear();
+    map_tag_index_size = 0;
+    maps_by_depth.clear();
+    maps_by_place.clear();
+    map_level_index_size = 0;
+}
+
+// Add any maps loaded since the last call to the tag index.
+static void _update_map_tag_index()
+{
+    for (; map_tag_index_size < vdefs.size(); ++map_tag_index_size)
+    {
+        const unsigned i = map_tag_index_size;
+        for (const string &tag : vdefs[i].get_tags())
+        {
+            if (tag.empty())
+                continue;
+
+            auto found = map_tag_ids.find(tag);
+            if (found == map_tag_ids.end())
+            {
+                found = map_tag_ids.emplace(tag, maps_by_tag.size()).first;
+                maps_by_tag.emplace_back();
+            }
+
+            vault_indices &maps = maps_by_tag[found->second];
+            if (maps.empty() || maps.back() != i)
+                maps.push_back(i);
+        }
+    }
+}
+
+// The maps that might have all of the (space-separated) tags given: those
+// with whichever of the tags is rarest. nullptr if some tag is unknown.
+static const vault_indices *_maps_for_tag_candidates(const string &tag)
+{
+    _update_map_tag_index();
+
+    const vault_indices *best = nullptr;
+    for (const string &word : split_string(" ", tag))
+    {
+        auto found = map_tag_ids.find(word);
+        if (found == map_tag_ids.end())
+            return nullptr;
+        const vault_indices &maps = maps_by_tag[found->second];
+        if (!best || maps.size() < best->size())
+            best = &maps;
+    }
+    return best;
+}
+
+static bool _map_index_stale()
+{
+    if (map_level_index_size != vdefs.size())
+        return true;
+    for (int i = 0; i < NUM_BRANCHES; ++i)
+        if (map_index_brdepth[i] != brdepth[i])
+            return true;
+    return false;
+}
+
+static const vault_indices &_maps_for_level(const level_id &place,
+                                            bool by_place)
+{
+    if (_map_index_stale())
+    {
+        maps_by_depth.clear();
+        maps_by_place.clear();
+        map_index_brdepth = brdepth;
+        map_level_index_size = vdefs.size();
+    }
+
+    map<level_id, vault_indices> &index = by_place ? maps_by_place
+                                                   : maps_by_depth;
+    auto found = index.find(place);
+    if (found != index.end())
+        return found->second;
+
+    vault_indices &maps = index[place];
+    for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
+    {
+        const depth_ranges &ranges = by_place ? vdefs[i].place
+                                              : vdefs[i].depths;
+        if (ranges.is_usable_in(place))
+            maps.push_back(i);
+    }
+    return maps;
+}
+
 mapref_vector find_maps_for_tag(const string tag,
                                 bool check_depth,
                                 bool check_used)
@@ -721,8 +841,13 @@ mapref_vector find_maps_for_tag(const string tag,
     mapref_vector maps;
     level_id place = level_id::current();
 
-    for (const map_def &mapdef : vdefs)
+    const vault_indices *candidates = _maps_for_tag_candidates(tag);
+    if (!candidates)
+        return maps;
+
+    for (unsigned i : *candidates)
     {
+        const map_def &mapdef = vdefs[i];
         if (mapdef.has_tag(tag)
             && !mapdef.has_tag("dummy")
             && (!check_depth || !mapdef.has_depth()
@@ -749,6 +874,7 @@ private:
 public:
     bool accept(const map_def &md) const;
     void announce(const map_def *map) const;
+    const vault_indices *candidates() const;
 
     bool valid() const
     {
@@ -890,6 +1016,23 @@ bool map_selector::accept(const map_def &mapdef) const
     }
 }
 
+// The maps that accept() could possibly take, or nullptr if none can.
+const vault_indices *map_selector::candidates() const
+{
+    switch (sel)
+    {
+    case PLACE:
+        return &_maps_for_level(place, true);
+    case DEPTH:
+    case DEPTH_AND_CHANCE:
+        return &_maps_for_level(place, false);
+    case TAG:
+        return _maps_for_tag_candidates(tag);
+    default:
+        return nullptr;
+    }
+}
+
 void map_selector::announce(const map_def *vault) const
 {
 #ifdef DEBUG_DIAGNOSTICS
@@ -931,15 +1074,17 @@ string vault_chance_tag(const map_def &map)
     return "";
 }
 
-typedef vector<unsigned> vault_indices;
-
 static vault_indices _eligible_maps_for_selector(const map_selector &sel)
 {
     vault_indices eligible;
 
     if (sel.valid())
     {
-        for (unsigned i = 0, size = vdefs.size(); i < size; ++i)
+        const vault_indices *candidates = sel.candidates();
+        if (!candidates)
+            return eligible;
+
+        for (unsigned i : *candidates)
             if (sel.accept(vdefs[i]))
                 eligible.push_back(i);
     }
@@ -1198,6 +1343,20 @@ static void _reset_map_parser()
 
 static bool checked_des_index_dir = false;
 
+// All des files compiled into one database, which every Crawl process
+// using this data directory maps and shares. Each des file has entries
+// for its index (.idx), full map definitions (.dsc) and global prelude
+// (.lux), keyed by its cache name plus that extension; each entry starts
+// with the version and des file mtime it was compiled from.
+#define MAP_CACHE_FILE "maps.fdb"
+static flat_db map_cache;
+static bool map_cache_checked = false;
+// Entries compiled by this process that aren't in map_cache yet. An empty
+// value means the entry should be dropped.
+static map<string, string> map_cache_updates;
+// While reading all the maps, saving the updates waits until the end.
+static bool reading_all_maps = false;
+
 static string _des_cache_dir(const string &relpath = "")
 {
     return catpath(savedir_versioned_path("des"), relpath);
@@ -1215,25 +1374,40 @@ static void _check_des_index_dir()
     checked_des_index_dir = true;
 }
 
-string get_descache_path(const string &file, const string &ext)
+bool map_cache_entry(const string &cache_name, const string &ext,
+                     const char *&data, size_t &len)
 {
-    const string basename = change_file_extension(get_base_filename(file), ext);
-    return _des_cache_dir(basename);
+    const string key = cache_name + ext;
+    auto updated = map_cache_updates.find(key);
+    if (updated != map_cache_updates.end())
+    {
+        data = updated->second.data();
+        len = updated->second.length();
+        return len > 0;
+    }
+
+    if (!map_cache_checked)
+    {
+        map_cache.open(_des_cache_dir(MAP_CACHE_FILE));
+        map_cache_checked = true;
+    }
+    return map_cache.query(key, data, len) && len > 0;
 }
 
-static bool verify_file_version(const string &file, time_t mtime)
+static bool _verify_map_entry(const string &cache_name, const string &ext,
+                              time_t mtime)
 {
-    FILE *fp = fopen_u(file.c_str(), "rb");
-    if (!fp)
+    const char *data;
+    size_t len;
+    if (!map_cache_entry(cache_name, ext, data, len))
         return false;
     try
     {
-        reader inf(fp);
+        reader inf(data, len);
         const uint8_t major = unmarshallUByte(inf);
         const uint8_t minor = unmarshallUByte(inf);
         const int8_t word = unmarshallByte(inf);
         const int64_t t = unmarshallSigned(inf);
-        fclose(fp);
         return major == TAG_MAJOR_VERSION
                && minor <= TAG_MINOR_VERSION
                && word == WORD_LEN
@@ -1241,28 +1415,19 @@ static bool verify_file_version(const string &file, time_t mtime)
     }
     catch (short_read_exception &E)
     {
-        fclose(fp);
         return false;
     }
 }
 
-static bool _verify_map_index(const string &base, time_t mtime)
+static bool _load_map_index(const string& cache, time_t mtime)
 {
-    return verify_file_version(base + ".idx", mtime);
-}
-
-static bool _verify_map_full(const string &base, time_t mtime)
-{
-    return verify_file_version(base + ".dsc", mtime);
-}
+    const char *data;
+    size_t len;
 
-static bool _load_map_index(const string& cache, const string &base,
-                            time_t mtime)
-{
     // If there's a global prelude, load that first.
-    if (FILE *fp = fopen_u((base + ".lux").c_str(), "rb"))
+    if (map_cache_entry(cache, ".lux", data, len))
     {
-        reader inf(fp, TAG_MINOR_VERSION);
+        reader inf(data, len, TAG_MINOR_VERSION);
         uint8_t major = unmarshallUByte(inf);
         uint8_t minor = unmarshallUByte(inf);
         int8_t word = unmarshallByte(inf);
@@ -1274,17 +1439,14 @@ static bool _load_map_index(const string& cache, const string &base,
         }
 
         lc_global_prelude.read(inf);
-        fclose(fp);
 
         global_preludes.push_back(lc_global_prelude);
     }
 
-    FILE* fp = fopen_u((base + ".idx").c_str(), "rb");
-    if (!fp)
-        end(1, true, "Unable to read %s", (base + ".idx").c_str());
+    if (!map_cache_entry(cache, ".idx", data, len))
+        return false;
 
-    reader inf(fp, TAG_MINOR_VERSION);
-    // Re-check version, might have been modified in the meantime.
+    reader inf(data, len, TAG_MINOR_VERSION);
     uint8_t major = unmarshallUByte(inf);
     uint8_t minor = unmarshallUByte(inf);
     int8_t word = unmarshallByte(inf);
@@ -1315,82 +1477,66 @@ static bool _load_map_index(const string& cache, const string &base,
         lc_loaded_maps[vdef.name] = vdef.place_loaded_from;
         vdef.place_loaded_from.clear();
     }
-    fclose(fp);
 
     return true;
 }
 
 static bool _load_map_cache(const string &filename, const string &cachename)
 {
-    _check_des_index_dir();
-    const string descache_base = get_descache_path(cachename, "");
-
-    file_lock deslock(descache_base + ".lk", "rb", false);
-
     time_t mtime = file_modtime(filename);
-    string file_idx = descache_base + ".idx";
-    string file_dsc = descache_base + ".dsc";
 
-    // What's the point in checking these twice (here and in load_ma_index)?
-    if (!_verify_map_index(descache_base, mtime)
-        || !_verify_map_full(descache_base, mtime))
+    if (!_verify_map_entry(cachename, ".idx", mtime)
+        || !_verify_map_entry(cachename, ".dsc", mtime))
     {
         return false;
     }
 
-    return _load_map_index(cachename, descache_base, mtime);
+    return _load_map_index(cachename, mtime);
 }
 
-static void _write_map_prelude(const string &filebase, time_t mtime)
+static void _write_map_header(writer &outf, time_t mtime)
 {
-    const string luafile = filebase + ".lux";
-    if (lc_global_prelude.empty())
-    {
-        unlink_u(luafile.c_str());
-        return;
-    }
-
-    FILE *fp = fopen_u(luafile.c_str(), "wb");
-    writer outf(luafile, fp);
     marshallUByte(outf, TAG_MAJOR_VERSION);
     marshallUByte(outf, TAG_MINOR_VERSION);
     marshallByte(outf, WORD_LEN);
     marshallSigned(outf, mtime);
-    lc_global_prelude.write(outf);
-    fclose(fp);
 }
 
-static void _write_map_full(const string &filebase, size_t vs, size_t ve,
-                            time_t mtime)
+static void _set_map_cache_entry(const string &cache_name, const string &ext,
+                                 const vector<unsigned char> &buf)
 {
-    const string cfile = filebase + ".dsc";
-    FILE *fp = fopen_u(cfile.c_str(), "wb");
-    if (!fp)
-        end(1, true, "Unable to open %s for writing", cfile.c_str());
+    map_cache_updates[cache_name + ext].assign(buf.begin(), buf.end());
+}
 
-    writer outf(cfile, fp);
-    marshallUByte(outf, TAG_MAJOR_VERSION);
-    marshallUByte(outf, TAG_MINOR_VERSION);
-    marshallByte(outf, WORD_LEN);
-    marshallSigned(outf, mtime);
+static void _write_map_prelude(const string &cache_name, time_t mtime)
+{
+    vector<unsigned char> buf;
+    if (!lc_global_prelude.empty())
+    {
+        writer outf(&buf);
+        _write_map_header(outf, mtime);
+        lc_global_prelude.write(outf);
+    }
+    _set_map_cache_entry(cache_name, ".lux", buf);
+}
+
+static void _write_map_full(const string &cache_name, size_t vs, size_t ve,
+                            time_t mtime)
+{
+    vector<unsigned char> buf;
+    writer outf(&buf);
+    _write_map_header(outf, mtime);
     for (size_t i = vs; i < ve; ++i)
         vdefs[i].write_full(outf);
-    fclose(fp);
+    _set_map_cache_entry(cache_name, ".dsc", buf);
 }
 
-static void _write_map_index(const string &filebase, size_t vs, size_t ve,
+static void _write_map_index(const string &cache_name, size_t vs, size_t ve,
                              time_t mtime)
 {
-    const string cfile = filebase + ".idx";
-    FILE *fp = fopen_u(cfile.c_str(), "wb");
-    if (!fp)
-        end(1, true, "Unable to open %s for writing", cfile.c_str());
-
-    writer outf(cfile, fp);
-    marshallUByte(outf, TAG_MAJOR_VERSION);
-    marshallUByte(outf, TAG_MINOR_VERSION);
-    marshallByte(outf, WORD_LEN);
-    marshallSigned(outf, mtime);
+    vector<unsigned char> buf;
+    writer outf(&buf);
+    _write_map_header(outf, mtime);
     marshallShort(outf, ve > vs? ve - vs : 0);
     for (size_t i = vs; i < ve; ++i)
     {
@@ -1400,21 +1546,51 @@ static void _write_map_index(const string &filebase, size_t vs, size_t ve,
         vdefs[i].place_loaded_from.clear();
         vdefs[i].strip();
     }
-    fclose(fp);
+    _set_map_cache_entry(cache_name, ".idx", buf);
 }
 
 static void _write_map_cache(const string &filename, size_t vs, size_t ve,
                              time_t mtime)
 {
-    _check_des_index_dir();
+    _write_map_prelude(filename, mtime);
+    _write_map_full(filename, vs, ve, mtime);
+    _write_map_index(filename, vs, ve, mtime);
+}
+
+// Writes out a new map cache with the entries we've compiled, and maps
+// that instead of the old one. Entries for other des files are taken from
+// the cache as it is now, which another process may have updated.
+static void _save_map_cache()
+{
+    if (map_cache_updates.empty())
+        return;
 
-    const string descache_base = get_descache_path(filename, "");
+    _check_des_index_dir();
+    const string cachefile = _des_cache_dir(MAP_CACHE_FILE);
+    file_lock lock(cachefile + ".lk", "wb");
 
-    file_lock deslock(descache_base + ".lk", "wb");
+    flat_db_writer out;
+    {
+        flat_db current;
+        if (current.open(cachefile))
+        {
+            for (unsigned int i = 0; i < current.size(); ++i)
+            {
+                const string key = current.key_at(i);
+                if (!map_cache_updates.count(key))
+                    out.add(key, current.value_at(i));
+            }
+        }
+    }
+    for (const auto &entry : map_cache_updates)
+        if (!entry.second.empty())
+            out.add(entry.first, entry.second);
+    if (!out.write(cachefile))
+        end(1, true, "Unable to write %s", cachefile.c_str());
 
-    _write_map_prelude(descache_base, mtime);
-    _write_map_full(descache_base, vs, ve, mtime);
-    _write_map_index(descache_base, vs, ve, mtime);
+    map_cache_updates.clear();
+    map_cache.open(cachefile);
+    map_cache_checked = true;
 }
 
 static void _parse_maps(const string &s)
@@ -1458,12 +1634,23 @@ void read_map(const string &file)
     _dgn_flush_map_environments();
     // Force GC to prevent heap from swelling unnecessarily.
     dlua.gc();
+
+    if (!reading_all_maps)
+        _save_map_cache();
 }
 
 void read_maps()
 {
-    if (dlua.execfile("dlua/loadmaps.lua", true, true, true))
-        end(1, false, "Lua error: %s", dlua.error.c_str());
+    // Pick up a cache another process may have rewritten.
+    map_cache.close();
+    map_cache_checked = false;
+
+    {
+        unwind_bool reading(reading_all_maps, true);
+        if (dlua.execfile("dlua/loadmaps.lua", true, true, true))
+            end(1, false, "Lua error: %s", dlua.error.c_str());
+    }
+    _save_map_cache();
 
     lc_loaded_maps.clear();
 
@@ -1474,6 +1661,8 @@ void read_maps()
             brdepth[it->id] = it->numlevels;
         dlua.execfile("dlua/sanity.lua", true, true);
     }
+
+    _update_map_tag_index();
 }
 
 // If a .dsc file has been changed under the running Crawl, discard
@@ -1488,6 +1677,7 @@ void reread_maps()
 
     // BOOM!
     vdefs.clear();
+    _clear_map_index();
     map_files_read.clear();
     read_maps();
 }
@@ -60,7 +60,10 @@ void reread_maps();
 void read_map(const string &file);
 void run_map_global_preludes();
 void run_map_local_preludes();
-string get_descache_path(const string &file, const string &ext);
+// The compiled form of a des file (ext is ".idx", ".dsc" or ".lux"),
+// valid until the maps are read again. Returns false if there is none.
+bool map_cache_entry(const string &cache_name, const string &ext,
+                     const char *&data, size_t &len);
 
 typedef map<string, map_file_place> map_load_info_t;
 
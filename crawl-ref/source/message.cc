@@ -1098,23 +1098,78 @@ void dprf(diag_type param, const char *format, ...)
 
 static bool _updating_view = false;
 
-static bool _check_option(const string& line, msg_channel_type channel,
-                          const vector<message_filter>& option)
+// A list of message filters, compiled into one pattern set per channel.
+struct message_filter_set
 {
-    return any_of(begin(option),
-                  end(option),
-                  bind(mem_fn(&message_filter::is_filtered),
-                       placeholders::_1, channel, line));
+    FixedVector<text_pattern_set, NUM_MESSAGE_CHANNELS> patterns;
+    // Channels on which some filter matches every message.
+    FixedBitVector<NUM_MESSAGE_CHANNELS> match_all;
+
+    void add(const message_filter &mf)
+    {
+        for (int ch = 0; ch < NUM_MESSAGE_CHANNELS; ++ch)
+        {
+            if (mf.channel != -1 && mf.channel != ch)
+                continue;
+            if (mf.pattern.empty())
+                match_all.set(ch);
+            else
+                patterns[ch].add(mf.pattern);
+        }
+    }
+
+    // Does any filter in the set match this message?
+    bool matches(const string &line, msg_channel_type channel) const
+    {
+        return match_all[channel] || patterns[channel].matches(line);
+    }
+};
+
+// The message options, compiled so that each message is scanned once per
+// list rather than once per pattern. Rebuilt when the options change.
+struct message_option_patterns
+{
+    unsigned int generation = 0;
+    message_filter_set more;
+    message_filter_set flash_screen;
+    message_filter_set colours;
+    text_pattern_set notes;
+#ifdef USE_SOUND
+    text_pattern_set sounds;
+#endif
+};
+
+static const message_option_patterns &_option_patterns()
+{
+    static message_option_patterns pats;
+    if (pats.generation == Options.generation)
+        return pats;
+
+    pats = message_option_patterns();
+    pats.generation = Options.generation;
+    for (const message_filter &mf : Options.force_more_message)
+        pats.more.add(mf);
+    for (const message_filter &mf : Options.flash_screen_message)
+        pats.flash_screen.add(mf);
+    for (const message_colour_mapping &mcm : Options.message_colour_mappings)
+        pats.colours.add(mcm.message);
+    for (const text_pattern &pat : Options.note_messages)
+        pats.notes.add(pat);
+#ifdef USE_SOUND
+    for (const sound_mapping &sound : Options.sound_mappings)
+        pats.sounds.add(sound.pattern);
+#endif
+    return pats;
 }
 
 static bool _check_more(const string& line, msg_channel_type channel)
 {
-    return _check_option(line, channel, Options.force_more_message);
+    return _option_patterns().more.matches(line, channel);
 }
 
 static bool _check_flash_screen(const string& line, msg_channel_type channel)
 {
-    return _check_option(line, channel, Options.flash_screen_message);
+    return _option_patterns().flash_screen.matches(line, channel);
 }
 
 static bool _check_join(const string& line, msg_channel_type channel)
@@ -1395,35 +1450,38 @@ static void mpr_check_patterns(const string& message,
                                msg_channel_type channel,
                                int param)
 {
-    for (const text_pattern &pat : Options.note_messages)
-    {
-        if (channel == MSGCH_EQUIPMENT || channel == MSGCH_FLOOR_ITEMS
-            || channel == MSGCH_MULTITURN_ACTION
-            || channel == MSGCH_EXAMINE || channel == MSGCH_EXAMINE_FILTER
-            || channel == MSGCH_TUTORIAL || channel == MSGCH_DGL_MESSAGE)
-        {
-            continue;
-        }
+    const message_option_patterns &pats = _option_patterns();
 
-        if (pat.matches(message))
-        {
-            take_note(Note(NOTE_MESSAGE, channel, param, message.c_str()));
-            break;
-        }
+    if (channel != MSGCH_EQUIPMENT && channel != MSGCH_FLOOR_ITEMS
+        && channel != MSGCH_MULTITURN_ACTION
+        && channel != MSGCH_EXAMINE && channel != MSGCH_EXAMINE_FILTER
+        && channel != MSGCH_TUTORIAL && channel != MSGCH_DGL_MESSAGE
+        && pats.notes.matches(message))
+    {
+        take_note(Note(NOTE_MESSAGE, channel, param, message.c_str()));
     }
 
-    if (channel != MSGCH_DIAGNOSTICS && channel != MSGCH_EQUIPMENT)
+    // Only a delay or a repeated command can be interrupted by a message,
+    // so don't build the string otherwise.
+    if (channel != MSGCH_DIAGNOSTICS && channel != MSGCH_EQUIPMENT
+        && (you_are_delayed() || crawl_state.is_repeating_cmd()))
+    {
         interrupt_activity(AI_MESSAGE, channel_to_str(channel) + ":" + message);
+    }
 
 #ifdef USE_SOUND
-    for (const sound_mapping &sound : Options.sound_mappings)
+    // The first matching sound wins, so if any match look for which.
+    if (pats.sounds.matches(message))
     {
-        // Maybe we should allow message channel matching as for
-        // force_more_message?
-        if (sound.pattern.matches(message))
+        for (const sound_mapping &sound : Options.sound_mappings)
         {
-            play_sound(sound.soundfile.c_str());
-            break;
+            // Maybe we should allow message channel matching as for
+            // force_more_message?
+            if (sound.pattern.matches(message))
+            {
+                play_sound(sound.soundfile.c_str());
+                break;
+            }
         }
     }
 #endif
@@ -1462,12 +1520,16 @@ static msg_colour_type prepare_message(const string& imsg,
     if (colour != MSGCOL_MUTED)
         mpr_check_patterns(imsg, channel, param);
 
-    for (const message_colour_mapping &mcm : Options.message_colour_mappings)
+    // The first matching mapping wins, so if any match look for which.
+    if (_option_patterns().colours.matches(imsg, channel))
     {
-        if (mcm.message.is_filtered(channel, imsg))
+        for (const message_colour_mapping &mcm : Options.message_colour_mappings)
         {
-            colour = mcm.colour;
-            break;
+            if (mcm.message.is_filtered(channel, imsg))
+            {
+                colour = mcm.colour;
+                break;
+            }
         }
     }
 
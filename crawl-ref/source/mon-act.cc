@@ -2761,16 +2761,121 @@ static void _post_monster_move(monster* mons)
         monster_die(mons, KILL_MISC, NON_MONSTER);
 }
 
-priority_queue<pair<monster *, int>,
-               vector<pair<monster *, int> >,
-               MonsterActionQueueCompare> monster_queue;
+// The monsters waiting to act this turn: a binary heap of monster indices,
+// highest energy first (ties going to the lower index). It also records
+// where each monster is in the heap, so a monster is only ever queued
+// once, and queueing it again just moves it to its new place.
+class monster_action_queue
+{
+public:
+    monster_action_queue() : heap(), where()
+    {
+        where.init(-1);
+    }
+
+    bool empty() const { return heap.empty(); }
+    int size() const { return heap.size(); }
+    monster *top() const { return &menv[heap[0].mindex]; }
+    // The energy the top monster had when it was queued.
+    int top_energy() const { return heap[0].energy; }
+
+    void push(monster *mons)
+    {
+        const int mindex = mons->mindex();
+        ASSERT_RANGE(mindex, 0, MAX_MONSTERS);
+        const entry e = { mindex, mons->speed_increment };
+
+        int i = where[mindex];
+        if (i == -1)
+        {
+            i = heap.size();
+            heap.push_back(e);
+        }
+        i = sift_up(i, e);
+        sift_down(i, e);
+    }
+
+    void pop()
+    {
+        where[heap[0].mindex] = -1;
+        const entry last = heap.back();
+        heap.pop_back();
+        if (!heap.empty())
+            sift_down(0, last);
+    }
 
-// Inserts a monster into the monster queue (needed to ensure that any monsters
+    void clear()
+    {
+        for (const entry &e : heap)
+            where[e.mindex] = -1;
+        heap.clear();
+    }
+
+private:
+    struct entry
+    {
+        int mindex;
+        int energy;
+    };
+
+    static bool _before(const entry &a, const entry &b)
+    {
+        return a.energy > b.energy
+               || a.energy == b.energy && a.mindex < b.mindex;
+    }
+
+    void put(int i, const entry &e)
+    {
+        heap[i] = e;
+        where[e.mindex] = i;
+    }
+
+    // Move e up from slot i as far as it should go; returns where it ended.
+    int sift_up(int i, const entry &e)
+    {
+        while (i > 0)
+        {
+            const int parent = (i - 1) / 2;
+            if (!_before(e, heap[parent]))
+                break;
+            put(i, heap[parent]);
+            i = parent;
+        }
+        put(i, e);
+        return i;
+    }
+
+    void sift_down(int i, const entry &e)
+    {
+        const int n = heap.size();
+        while (true)
+        {
+            int child = 2 * i + 1;
+            if (child >= n)
+                break;
+            if (child + 1 < n && _before(heap[child + 1], heap[child]))
+                ++child;
+            if (!_before(heap[child], e))
+                break;
+            put(i, heap[child]);
+            i = child;
+        }
+        put(i, e);
+    }
+
+    vector<entry> heap;
+    FixedVector<int, MAX_MONSTERS> where;
+};
+
+static monster_action_queue monster_queue;
+
+// Inserts a monster into the monster queue, or moves it to match its
+// current energy if it's already there (needed to ensure that any monsters
 // given energy or an action by a effect can actually make use of that energy
 // this round)
 void queue_monster_for_action(monster* mons)
 {
-    monster_queue.emplace(mons, mons->speed_increment);
+    monster_queue.push(mons);
 }
 
 static void _clear_monster_flags()
@@ -2812,7 +2917,7 @@ void handle_monsters(bool with_noise)
     {
         _pre_monster_move(*mi);
         if (!invalid_monster(*mi) && mi->alive() && mi->has_action_energy())
-            monster_queue.emplace(*mi, mi->speed_increment);
+            monster_queue.push(*mi);
     }
 
     int tries = 0; // infinite loop protection, shouldn't be ever needed
@@ -2821,36 +2926,42 @@ void handle_monsters(bool with_noise)
         if (tries++ > 32767)
         {
             die("infinite handle_monsters() loop, mons[0 of %d] is %s",
-                (int)monster_queue.size(),
-                monster_queue.top().first->name(DESC_PLAIN, true).c_str());
+                monster_queue.size(),
+                monster_queue.top()->name(DESC_PLAIN, true).c_str());
         }
 
-        monster *mon = monster_queue.top().first;
-        const int oldspeed = monster_queue.top().second;
-        monster_queue.pop();
+        monster *mon = monster_queue.top();
+        const int oldspeed = monster_queue.top_energy();
 
         if (invalid_monster(mon) || !mon->alive() || !mon->has_action_energy())
+        {
+            monster_queue.pop();
             continue;
+        }
 
-        _update_monster_attitude(mon);
-
-        // Only move the monster if nothing else has played with its energy
-        // during their turn.
-        // If something's played with the energy, they get added back to
-        // the queue just after this.
-        if (oldspeed == mon->speed_increment)
+        // If something else has played with the monster's energy since it
+        // was queued, just move it to its proper place in the queue.
+        if (oldspeed != mon->speed_increment)
         {
-            handle_monster_move(mon);
-            _post_monster_move(mon);
-            fire_final_effects();
+            monster_queue.push(mon);
+            continue;
         }
 
+        monster_queue.pop();
+
+        _update_monster_attitude(mon);
+
+        handle_monster_move(mon);
+        _post_monster_move(mon);
+        fire_final_effects();
+
         if (mon->has_action_energy())
-            monster_queue.emplace(mon, mon->speed_increment);
+            monster_queue.push(mon);
 
         // If the player got banished, discard pending monster actions.
         if (you.banished)
         {
+            monster_queue.clear();
             // Clear list of mesmerising monsters.
             you.clear_beholders();
             you.clear_fearmongers();
@@ -8,15 +8,6 @@
 
 struct bolt;
 
-class MonsterActionQueueCompare
-{
-public:
-    bool operator() (pair<monster*, int> m1, pair<monster*, int> m2)
-    {
-        return m1.second < m2.second;
-    }
-};
-
 bool mon_can_move_to_pos(const monster* mons, const coord_def& delta,
                          bool just_check = false);
 bool mons_can_move_towards_target(const monster* mon);
@@ -2567,12 +2567,7 @@ item_def* monster_die(monster* mons, killer_type killer,
         arena_monster_died(mons, killer, killer_index, silent, corpse);
 
     // Monsters haloes should be removed when they die.
-    if (mons->halo_radius()
-        || mons->umbra_radius()
-        || mons->silence_radius())
-    {
-        invalidate_agrid();
-    }
+    areas_monster_died(mons);
 
     const coord_def mwhere = mons->pos();
     if (drop_items)
@@ -2,6 +2,8 @@
 
 #include "mon-pathfind.h"
 
+#include <memory>
+
 #include "directn.h"
 #include "env.h"
 #include "los.h"
@@ -18,13 +20,13 @@
 // The pathfinding is an implementation of the A* algorithm. Beginning at the
 // monster position we check all neighbours of a given grid, estimate the
 // distance needed for any shortest path including this grid and push the
-// result into a hash. We can then easily access all points with the shortest
-// distance estimates and then check _their_ neighbours and so on.
+// result into a bucket queue. We can then easily access all points with the
+// shortest distance estimates and then check _their_ neighbours and so on.
 // The algorithm terminates once we reach the destination since - because
-// of the sorting of grids by shortest distance in the hash - there can be no
-// path between start and target that is shorter than the current one. There
+// of the sorting of grids by shortest distance in the buckets - there can be
+// no path between start and target that is shorter than the current one. There
 // could be other paths that have the same length but that has no real impact.
-// If the hash has been cleared and the start grid has not been encountered,
+// If the buckets have been emptied and the start grid has not been encountered,
 // then there's no path that matches the requirements fed into monster_pathfind.
 // (These requirements are usually preference of habitat of a specific monster
 // or a limit of the distance between start and any grid on the path.)
@@ -64,16 +66,168 @@ int mons_tracking_range(const monster* mon)
     return range;
 }
 
+// The per-search state: distances and backtracking information for every
+// grid, and the open list as a bucket queue keyed by total estimated path
+// length. Every grid and bucket carries the generation in which it was last
+// written; anything older counts as unvisited or empty, so starting a new
+// search is just a matter of bumping the generation.
+//
+// Each bucket is a stack threaded through the grids it contains, so that
+// grids can be removed from the middle in O(1) when their estimate improves,
+// without changing the order of the rest.
+struct pathfind_workspace
+{
+    static const int NCELLS = GXM * GYM;
+
+    uint32_t generation;
+    uint32_t cell_gen[NCELLS];
+    int dist[NCELLS];
+    int8_t prev[NCELLS];
+    // Whether the grid is in a bucket, and its neighbours there, towards
+    // the bottom and the top.
+    bool queued[NCELLS];
+    int below[NCELLS];
+    int above[NCELLS];
+
+    uint32_t bucket_gen[NCELLS];
+    int bucket_top[NCELLS];
+
+    pathfind_workspace() : generation(0)
+    {
+        memset(cell_gen, 0, sizeof(cell_gen));
+        memset(bucket_gen, 0, sizeof(bucket_gen));
+    }
+
+    void reset()
+    {
+        if (++generation == 0)
+        {
+            memset(cell_gen, 0, sizeof(cell_gen));
+            memset(bucket_gen, 0, sizeof(bucket_gen));
+            generation = 1;
+        }
+    }
+
+    static int index(const coord_def &c)
+    {
+        return c.y * GXM + c.x;
+    }
+
+    int get_dist(const coord_def &c) const
+    {
+        const int i = index(c);
+        return cell_gen[i] == generation ? dist[i] : INFINITE_DISTANCE;
+    }
+
+    int get_prev(const coord_def &c) const
+    {
+        const int i = index(c);
+        return cell_gen[i] == generation ? prev[i] : 0;
+    }
+
+    // Brings a grid left over from an earlier search into this one, as
+    // unvisited and not in any bucket.
+    void touch(int i)
+    {
+        if (cell_gen[i] != generation)
+        {
+            cell_gen[i] = generation;
+            dist[i] = INFINITE_DISTANCE;
+            prev[i] = 0;
+            queued[i] = false;
+        }
+    }
+
+    void set(const coord_def &c, int d, int dir)
+    {
+        const int i = index(c);
+        touch(i);
+        dist[i] = d;
+        prev[i] = dir;
+    }
+
+    bool bucket_empty(int b) const
+    {
+        return bucket_gen[b] != generation || bucket_top[b] < 0;
+    }
+
+    void push(int b, const coord_def &c)
+    {
+        ASSERT(b >= 0 && b < NCELLS);
+        if (bucket_gen[b] != generation)
+        {
+            bucket_gen[b] = generation;
+            bucket_top[b] = -1;
+        }
+        const int i = index(c);
+        touch(i);
+        queued[i] = true;
+        below[i] = bucket_top[b];
+        above[i] = -1;
+        if (bucket_top[b] >= 0)
+            above[bucket_top[b]] = i;
+        bucket_top[b] = i;
+    }
+
+    // Pops the grid most recently pushed into a non-empty bucket.
+    coord_def pop(int b)
+    {
+        const int i = bucket_top[b];
+        queued[i] = false;
+        bucket_top[b] = below[i];
+        if (below[i] >= 0)
+            above[below[i]] = -1;
+        return coord_def(i % GXM, i / GXM);
+    }
+
+    // Removes c from bucket b, if it's still there.
+    void remove(int b, const coord_def &c)
+    {
+        const int i = index(c);
+        if (!queued[i])
+            return;
+        queued[i] = false;
+        if (above[i] >= 0)
+            below[above[i]] = below[i];
+        else
+            bucket_top[b] = below[i];
+        if (below[i] >= 0)
+            above[below[i]] = above[i];
+    }
+};
+
+// Workspaces are large, so rather than building one for every
+// monster_pathfind, finished ones are kept for reuse. Several searches can
+// be alive at once, hence a pool rather than a single instance.
+static thread_local vector<unique_ptr<pathfind_workspace>> _free_workspaces;
+
+static pathfind_workspace *_acquire_workspace()
+{
+    if (_free_workspaces.empty())
+        return new pathfind_workspace;
+
+    pathfind_workspace *ws = _free_workspaces.back().release();
+    _free_workspaces.pop_back();
+    return ws;
+}
+
+static void _release_workspace(pathfind_workspace *ws)
+{
+    _free_workspaces.emplace_back(ws);
+}
+
 //#define DEBUG_PATHFIND
 monster_pathfind::monster_pathfind()
     : mons(nullptr), start(), target(), pos(), allow_diagonals(true),
       traverse_unmapped(false), range(0), min_length(0), max_length(0),
-      dist(), prev(), hash()
+      ws(_acquire_workspace())
 {
+    ws->reset();
 }
 
 monster_pathfind::~monster_pathfind()
 {
+    _release_workspace(ws);
 }
 
 void monster_pathfind::set_range(int r)
@@ -84,7 +238,7 @@ void monster_pathfind::set_range(int r)
 
 coord_def monster_pathfind::next_pos(const coord_def &c) const
 {
-    return c + Compass[prev[c.x][c.y]];
+    return c + Compass[ws->get_prev(c)];
 }
 
 // The main method in the monster_pathfind class.
@@ -140,17 +294,14 @@ bool monster_pathfind::start_pathfind(bool msg)
     //       a wall.
 
     max_length = min_length = grid_distance(pos, target);
-    for (int i = 0; i < GXM; i++)
-        for (int j = 0; j < GYM; j++)
-            dist[i][j] = INFINITE_DISTANCE;
-
-    dist[pos.x][pos.y] = 0;
+    ws->reset();
+    ws->set(pos, 0, 0);
 
     bool success = false;
     do
     {
         // Calculate the distance to all neighbours of the current position,
-        // and add them to the hash, if they haven't already been looked at.
+        // and add them to the buckets, if they haven't already been looked at.
         success = calc_path_to_neighbours();
         if (success)
             return true;
@@ -214,8 +365,8 @@ bool monster_pathfind::calc_path_to_neighbours()
         if (range && estimated_cost(npos) > range)
             continue;
 
-        distance = dist[pos.x][pos.y] + travel_cost(npos);
-        old_dist = dist[npos.x][npos.y];
+        distance = ws->get_dist(pos) + travel_cost(npos);
+        old_dist = ws->get_dist(npos);
 
         // Also bail out if this would make the path longer than twice the
         // allowed distance from the target. (This factor may need tuning.)
@@ -243,7 +394,7 @@ bool monster_pathfind::calc_path_to_neighbours()
             if (old_dist == INFINITE_DISTANCE)
             {
 #ifdef DEBUG_PATHFIND
-                mprf("Adding (%d,%d) to hash (total dist = %d)",
+                mprf("Adding (%d,%d) to bucket (total dist = %d)",
                      npos.x, npos.y, total);
 #endif
                 add_new_pos(npos, total);
@@ -260,16 +411,13 @@ bool monster_pathfind::calc_path_to_neighbours()
                 update_pos(npos, total);
             }
 
-            // Update distance start->pos.
-            dist[npos.x][npos.y] = distance;
-
-            // Set backtracking information.
-            // Converts the Compass direction to its counterpart.
+            // Update distance start->pos, and set backtracking information.
+            // The latter converts the Compass direction to its counterpart.
             //      0  1  2         4  5  6
             //      7  .  3   ==>   3  .  7       e.g. (3 + 4) % 8          = 7
             //      6  5  4         2  1  0            (7 + 4) % 8 = 11 % 8 = 3
 
-            prev[npos.x][npos.y] = (dir + 4) % 8;
+            ws->set(npos, distance, (dir + 4) % 8);
 
             // Are we finished?
             if (npos == target)
@@ -285,22 +433,20 @@ bool monster_pathfind::calc_path_to_neighbours()
 }
 
 // Starting at known min_length (minimum total estimated path distance), check
-// the hash for existing vectors, then pick the last entry of the first vector
-// that matches. Update min_length, if necessary.
+// the buckets for existing entries, then pick the last entry of the first
+// bucket that matches. Update min_length, if necessary.
 bool monster_pathfind::get_best_position()
 {
     for (int i = min_length; i <= max_length; i++)
     {
-        if (!hash[i].empty())
+        if (!ws->bucket_empty(i))
         {
             if (i > min_length)
                 min_length = i;
 
-            vector<coord_def> &vec = hash[i];
-            // Pick the last position pushed into the vector as it's most
+            // Pick the last position pushed into the bucket as it's most
             // likely to be close to the target.
-            pos = vec[vec.size()-1];
-            vec.pop_back();
+            pos = ws->pop(i);
 
 #ifdef DEBUG_PATHFIND
             mprf("Returning (%d, %d) as best pos with total dist %d.",
@@ -335,7 +481,7 @@ vector<coord_def> monster_pathfind::backtrack()
     int dir;
     do
     {
-        dir = prev[pos.x][pos.y];
+        dir = ws->get_prev(pos);
         pos = pos + Compass[dir];
         ASSERT_IN_BOUNDS(pos);
 #ifdef DEBUG_PATHFIND
@@ -505,24 +651,79 @@ int monster_pathfind::estimated_cost(coord_def p)
 
 void monster_pathfind::add_new_pos(coord_def npos, int total)
 {
-    hash[total].push_back(npos);
+    ws->push(total, npos);
 }
 
 void monster_pathfind::update_pos(coord_def npos, int total)
 {
-    // Find hash position of old distance and delete it,
-    // then call_add_new_pos.
-    int old_total = dist[npos.x][npos.y] + estimated_cost(npos);
+    // Remove the grid from the bucket of its old total distance,
+    // then call add_new_pos.
+    const int old_total = ws->get_dist(npos) + estimated_cost(npos);
+    ws->remove(old_total, npos);
 
-    vector<coord_def> &vec = hash[old_total];
-    for (unsigned int i = 0; i < vec.size(); i++)
+    add_new_pos(npos, total);
+}
+
+/********************/
+/* regression tests */
+/********************/
+#ifdef DEBUG_TESTS
+// Drives the open list the way calc_path_to_neighbours() does.
+class pathfind_tester : public monster_pathfind
+{
+public:
+    pathfind_tester()
     {
-        if (vec[i] == npos)
-        {
-            vec.erase(vec.begin() + i);
-            break;
-        }
+        target = coord_def(40, 40);
+        min_length = 0;
+        max_length = 2 * GXM;
     }
 
-    add_new_pos(npos, total);
+    void visit(const coord_def &c, int distance)
+    {
+        const int total = distance + estimated_cost(c);
+        if (ws->get_dist(c) == INFINITE_DISTANCE)
+            add_new_pos(c, total);
+        else
+            update_pos(c, total);
+        ws->set(c, distance, 0);
+    }
+
+    bool pop(coord_def &c)
+    {
+        if (!get_best_position())
+            return false;
+        c = pos;
+        return true;
+    }
+};
+
+void pathfind_tests()
+{
+    pathfind_tester pf;
+    const coord_def a(10, 10), b(11, 11), c(12, 12);
+
+    // a is added and then improved twice, each time into a bucket that
+    // already holds another grid.
+    pf.visit(b, 21);
+    pf.visit(a, 20);
+    pf.visit(c, 12);
+    pf.visit(a, 15);
+    pf.visit(a, 10);
+
+    map<coord_def, int> pops;
+    coord_def p;
+    for (int n = 0; pf.pop(p); ++n)
+    {
+        if (n >= 3)
+            die("pathfind: open list holds more than 3 grids");
+        ++pops[p];
+    }
+
+    for (const coord_def &q : { a, b, c })
+    {
+        if (pops[q] != 1)
+            die("pathfind: %d,%d popped %d times", q.x, q.y, pops[q]);
+    }
 }
+#endif
@@ -2,14 +2,20 @@
 #define MON_PATHFIND_H
 
 class monster;
+struct pathfind_workspace;
 
 int mons_tracking_range(const monster* mon);
 
+#ifdef DEBUG_TESTS
+void pathfind_tests();
+#endif
+
 class monster_pathfind
 {
 public:
     monster_pathfind();
     virtual ~monster_pathfind();
+    DISALLOW_COPY_AND_ASSIGN(monster_pathfind);
 
     // public methods
     void set_range(int r);
@@ -60,12 +66,9 @@ protected:
     int min_length;
     int max_length;
 
-    // The array of distances from start to any already tried point.
-    int dist[GXM][GYM];
-    // An array to store where we came from on a given shortest path.
-    int prev[GXM][GYM];
-
-    FixedVector<vector<coord_def>, GXM * GYM> hash;
+    // Distances, backtracking information and the open list, borrowed
+    // from a per-thread pool for as long as this object lives.
+    pathfind_workspace *ws;
 };
 
 #endif
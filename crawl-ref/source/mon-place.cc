@@ -1172,6 +1172,7 @@ monster* get_free_monster()
         if (env.mons[i].type == MONS_NO_MONSTER)
         {
             env.mons[i].reset();
+            mons_slot_used(&env.mons[i]);
             return &env.mons[i];
         }
 
@@ -4857,6 +4857,45 @@ void reset_all_monsters()
     env.mid_cache.clear();
 }
 
+// The index of mons in env.mons, or -1 if it's some other monster (a
+// copy, say).
+static int _mons_slot(const monster *mons)
+{
+    const monster *first = menv.buffer();
+    if (less<const monster *>()(mons, first)
+        || !less<const monster *>()(mons, first + MAX_MONSTERS))
+    {
+        return -1;
+    }
+    return mons - first;
+}
+
+// Record that mons's slot in env.mons is (or is about to be) in use.
+void mons_slot_used(const monster *mons)
+{
+    const int slot = _mons_slot(mons);
+    if (slot == -1)
+        return;
+
+    vector<int> &used = env.mons_used;
+    auto pos = lower_bound(used.begin(), used.end(), slot);
+    if (pos == used.end() || *pos != slot)
+        used.insert(pos, slot);
+}
+
+// Record that mons's slot in env.mons is free again.
+void mons_slot_unused(const monster *mons)
+{
+    const int slot = _mons_slot(mons);
+    if (slot == -1)
+        return;
+
+    vector<int> &used = env.mons_used;
+    auto pos = lower_bound(used.begin(), used.end(), slot);
+    if (pos != used.end() && *pos == slot)
+        used.erase(pos);
+}
+
 bool mons_is_recallable(actor* caller, monster* targ)
 {
     // For player, only recall friendly monsters
@@ -467,6 +467,8 @@ bool mons_stores_tracking_data(const monster* mons);
 bool mons_is_player_shadow(const monster* mon);
 
 void reset_all_monsters();
+void mons_slot_used(const monster *mons);
+void mons_slot_unused(const monster *mons);
 void debug_mondata();
 void debug_monspells();
 
@@ -157,6 +157,8 @@ void monster::reset()
     // Just for completeness.
     speed           = 0;
     colour         = COLOUR_INHERIT;
+
+    mons_slot_unused(this);
 }
 
 void monster::init_with(const monster& mon)
@@ -200,6 +202,9 @@ void monster::init_with(const monster& mon)
         ghost.reset(new ghost_demon(*mon.ghost));
     else
         ghost.reset(nullptr);
+
+    if (type != MONS_NO_MONSTER)
+        mons_slot_used(this);
 }
 
 uint32_t monster::last_client_id = 0;
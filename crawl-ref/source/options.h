@@ -133,6 +133,9 @@ public:
     string      filename;     // The name of the file containing options.
     string      basefilename; // Base (pathless) file name
     int         line_num;     // Current line number being processed.
+    // Bumped whenever options are reset or an option line is read, so
+    // that anything derived from the options can tell it's out of date.
+    unsigned int generation;
 
     // View options
     map<dungeon_feature_type, feature_def> feature_colour_overrides;
@@ -150,6 +153,7 @@ public:
     string      shared_dir;     // Directory where the logfile, scores and bones
                                 // are stored. On a multi-user system, this dir
                                 // should be accessible by different people.
+    int         level_gen_log_ms; // Log levels slower than this to build.
     vector<string> additional_macro_files;
 
     uint32_t    seed;   // Non-random games.
@@ -15,6 +15,8 @@
 
 #include "pattern.h"
 
+#include "libutil.h"
+
 #if defined(REGEX_PCRE)
 ////////////////////////////////////////////////////////////////////
 // Perl Compatible Regular Expressions
@@ -143,3 +145,113 @@ bool text_pattern::matches(const char *s, int length) const
 {
     return valid() && _pattern_match(compiled_pattern, s, length);
 }
+
+////////////////////////////////////////////////////////////////////
+// Pattern sets
+
+#if defined(REGEX_PCRE)
+// Can this pattern be put in a group alongside others without changing
+// what it matches? Anything that refers to other groups by number, the
+// backtracking control verbs (which could stop later alternatives from
+// being tried), and quoting or extended-mode comments (which could swallow
+// the closing parenthesis) rule it out. This errs on the side of caution.
+static bool _can_combine(const string &pattern)
+{
+    const int len = pattern.length();
+    for (int i = 0; i < len - 1; ++i)
+    {
+        const char c = pattern[i];
+        const char next = pattern[i + 1];
+        if (c == '\\')
+        {
+            if (isadigit(next) || next == 'g' || next == 'k' || next == 'Q')
+                return false;
+            ++i;
+        }
+        else if (c == '(' && next == '*')
+            return false;
+        else if (c == '(' && next == '?' && i + 2 < len)
+        {
+            const char kind = pattern[i + 2];
+            if (isadigit(kind) || kind == '+' || kind == '&' || kind == 'R'
+                || kind == 'P' || kind == '(')
+            {
+                return false;
+            }
+            // Option settings: (?-1) is a group reference, and (?x)
+            // turns on comments.
+            for (int j = i + 2; j < len && (isalpha(pattern[j])
+                                            || pattern[j] == '-'); ++j)
+            {
+                if (pattern[j] == 'x'
+                    || pattern[j] == '-' && j + 1 < len
+                       && isadigit(pattern[j + 1]))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+#endif
+
+void text_pattern_set::add(const text_pattern &tp)
+{
+    // Patterns that would never match can be left out altogether.
+    if (!tp.valid())
+        return;
+
+#if defined(REGEX_PCRE)
+    if (_can_combine(tp.pattern))
+    {
+        if (!combined_source.empty())
+            combined_source += "|";
+        combined_source += tp.ignore_case ? "(?i:" : "(?:";
+        combined_source += tp.pattern;
+        combined_source += ")";
+        combinable.push_back(tp);
+        combined = text_pattern();
+        return;
+    }
+#endif
+
+    separate.push_back(tp);
+}
+
+void text_pattern_set::clear()
+{
+    combinable.clear();
+    separate.clear();
+    combined_source.clear();
+    combined = text_pattern();
+}
+
+bool text_pattern_set::matches(const string &s) const
+{
+    if (!combinable.empty())
+    {
+        if (combined.empty())
+            combined = combined_source;
+
+        if (combined.valid())
+        {
+            if (combined.matches(s))
+                return true;
+        }
+        else
+        {
+            // Shouldn't happen, since every part compiled on its own,
+            // but fall back to checking them one by one.
+            for (const text_pattern &tp : combinable)
+                if (tp.matches(s))
+                    return true;
+        }
+    }
+
+    for (const text_pattern &tp : separate)
+        if (tp.matches(s))
+            return true;
+
+    return false;
+}
@@ -71,5 +71,28 @@ private:
     mutable void *compiled_pattern;
     mutable bool isvalid;
     bool ignore_case;
+
+    friend class text_pattern_set;
+};
+
+// A list of text_patterns compiled together into one alternation, so that
+// checking a string against all of them (usually to find that none match)
+// takes a single scan. Patterns that can't safely be combined, and all of
+// them when regexes aren't PCRE, are tried one at a time instead.
+class text_pattern_set
+{
+public:
+    void add(const text_pattern &tp);
+    void clear();
+    bool empty() const { return combinable.empty() && separate.empty(); }
+
+    // Does any pattern in the set match s?
+    bool matches(const string &s) const;
+
+private:
+    vector<text_pattern> combinable;
+    vector<text_pattern> separate;
+    string combined_source;
+    mutable text_pattern combined;
 };
 #endif
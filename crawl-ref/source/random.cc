@@ -40,6 +40,20 @@ void seed_rng()
     seed_asg(seed_key, 5);
 }
 
+rng_stream::rng_stream(uint32_t seed, uint32_t stream)
+    : saved(AsgKISS::generator())
+{
+    uint32_t key[5];
+    for (size_t i = 0; i < ARRAYSZ(key); ++i)
+        key[i] = hash3(seed, stream, i);
+    AsgKISS::generator() = AsgKISS(key, ARRAYSZ(key));
+}
+
+rng_stream::~rng_stream()
+{
+    AsgKISS::generator() = saved;
+}
+
 uint32_t random_int()
 {
     return get_uint32();
@@ -6,11 +6,27 @@
 #include <map>
 #include <vector>
 
+#include "asg.h"
 #include "hash.h"
 
 void seed_rng();
 void seed_rng(uint32_t seed);
 
+// While one of these is in scope, the main RNG draws from a stream of its
+// own, fixed by seed and stream. Afterwards the main RNG carries on from
+// where it left off, as if nothing had used it in between.
+class rng_stream
+{
+public:
+    rng_stream(uint32_t seed, uint32_t stream);
+    ~rng_stream();
+
+private:
+    AsgKISS saved;
+
+    DISALLOW_COPY_AND_ASSIGN(rng_stream);
+};
+
 bool coinflip();
 int div_rand_round(int num, int den);
 int div_round_up(int num, int den);
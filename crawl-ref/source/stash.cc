@@ -159,7 +159,7 @@ static void _fully_identify_item(item_def *item)
 // Stash
 // ----------------------------------------------------------------------
 
-Stash::Stash(int xp, int yp) : enabled(true), items()
+Stash::Stash(int xp, int yp) : enabled(true), items(), search_generation(0)
 {
     // First, fix what square we're interested in
     if (xp == -1)
@@ -256,11 +256,15 @@ bool Stash::unmark_trapping_nets()
     for (auto &item : items)
         if (item_is_stationary_net(item))
             item.net_placed = false, changed = true;
+    if (changed)
+        search_generation = 0;
     return changed;
 }
 
 void Stash::update()
 {
+    search_generation = 0;
+
     coord_def p(x,y);
     feat = grd(p);
     trap = NUM_TRAPS;
@@ -598,6 +602,28 @@ string Stash::feature_description() const
     return feat_desc;
 }
 
+const vector<stash_search_text> &Stash::searchable_text() const
+{
+    const unsigned int generation = StashTrack.search_generation();
+    if (search_generation == generation)
+        return search_cache;
+
+    search_cache.clear();
+    for (const item_def &item : items)
+    {
+        stash_search_text text;
+        text.name = stash_item_name(item);
+        text.annotated = stash_annotate_item(STASH_LUA_SEARCH_ANNOTATE, &item)
+                         + text.name;
+        if (is_dumpable_artefact(item))
+            text.desc = chardump_desc(item);
+        search_cache.push_back(text);
+    }
+    search_generation = generation;
+
+    return search_cache;
+}
+
 bool Stash::matches_search(const string &prefix,
                            const base_pattern &search,
                            stash_search_result &res) const
@@ -605,28 +631,18 @@ bool Stash::matches_search(const string &prefix,
     if (!enabled || items.empty() && feat == DNGN_FLOOR)
         return false;
 
-    for (const item_def &item : items)
+    const vector<stash_search_text> &texts = searchable_text();
+    for (int i = 0, count = items.size(); i < count; ++i)
     {
-        const string s   = stash_item_name(item);
-        const string ann = stash_annotate_item(STASH_LUA_SEARCH_ANNOTATE, &item);
-        if (search.matches(prefix + " " + ann + s))
+        const item_def &item = items[i];
+        const stash_search_text &text = texts[i];
+        if (search.matches(prefix + " " + text.annotated)
+            || is_dumpable_artefact(item) && search.matches(text.desc))
         {
             if (!res.count++)
-                res.match = s;
+                res.match = text.name;
             res.matches += item.quantity;
             res.matching_items.push_back(item);
-            continue;
-        }
-
-        if (is_dumpable_artefact(item))
-        {
-            if (search.matches(chardump_desc(item)))
-            {
-                if (!res.count++)
-                    res.match = s;
-                res.matches += item.quantity;
-                res.matching_items.push_back(item);
-            }
         }
     }
 
@@ -662,6 +678,7 @@ void Stash::_update_corpses(int rot_time)
 
         int new_rot = static_cast<int>(item.stash_freshness) - rot_time;
 
+        search_generation = 0;
         if (new_rot <= _min_rot(item))
         {
             items.erase(items.begin() + i);
@@ -675,13 +692,18 @@ void Stash::_update_identification()
 {
     for (int i = items.size() - 1; i >= 0; i--)
     {
+        const iflags_t old_flags = items[i].flags;
         god_id_item(items[i]);
         maybe_identify_base_type(items[i]);
+        if (items[i].flags != old_flags)
+            search_generation = 0;
     }
 }
 
 void Stash::add_item(const item_def &item, bool add_to_front)
 {
+    search_generation = 0;
+
     if (_is_rottable(item))
         StashTrack.update_corpses();
 
@@ -803,6 +825,7 @@ void Stash::load(reader& inf)
 
     // Zap out item vector, in case it's in use (however unlikely)
     items.clear();
+    search_generation = 0;
     // Read in the items
     for (int i = 0; i < count; ++i)
     {
@@ -814,7 +837,8 @@ void Stash::load(reader& inf)
 }
 
 ShopInfo::ShopInfo(int xp, int yp) : x(xp), y(yp), name(), shoptype(-1),
-                                     visited(false), items()
+                                     visited(false), items(),
+                                     search_generation(0)
 {
     // Most of our initialization will be done externally; this class is really
     // a mildly glorified struct.
@@ -829,6 +853,7 @@ void ShopInfo::add_item(const item_def &sitem, unsigned price)
     it.item  = sitem;
     it.price = price;
     items.push_back(it);
+    search_generation = 0;
 }
 
 string ShopInfo::shop_item_name(const shop_item &si) const
@@ -984,6 +1009,28 @@ string ShopInfo::description() const
     return name;
 }
 
+const vector<stash_search_text> &ShopInfo::searchable_text() const
+{
+    const unsigned int generation = StashTrack.search_generation();
+    if (search_generation == generation)
+        return search_cache;
+
+    search_cache.clear();
+    for (const shop_item &item : items)
+    {
+        stash_search_text text;
+        text.name = shop_item_name(item);
+        text.annotated = stash_annotate_item(STASH_LUA_SEARCH_ANNOTATE,
+                                             &item.item, true)
+                         + text.name;
+        text.desc = shop_item_desc(item);
+        search_cache.push_back(text);
+    }
+    search_generation = generation;
+
+    return search_cache;
+}
+
 bool ShopInfo::matches_search(const string &prefix,
                               const base_pattern &search,
                               stash_search_result &res) const
@@ -996,28 +1043,17 @@ bool ShopInfo::matches_search(const string &prefix,
 
     bool match = false;
 
-    for (const shop_item &item : items)
+    const vector<stash_search_text> &texts = searchable_text();
+    for (int i = 0, count = items.size(); i < count; ++i)
     {
-        const string sname = shop_item_name(item);
-        const string ann   = stash_annotate_item(STASH_LUA_SEARCH_ANNOTATE,
-                                                 &item.item, true);
-
-        bool thismatch = false;
-        if (search.matches(prefix + " " + ann + sname))
-            thismatch = true;
-        else
-        {
-            string desc = shop_item_desc(item);
-            if (search.matches(desc))
-                thismatch = true;
-        }
-
-        if (thismatch)
+        const stash_search_text &text = texts[i];
+        if (search.matches(prefix + " " + text.annotated)
+            || search.matches(text.desc))
         {
             if (!res.count++)
-                res.match = sname;
+                res.match = text.name;
             res.matches++;
-            res.matching_items.push_back(item.item);
+            res.matching_items.push_back(items[i].item);
         }
     }
 
@@ -1119,6 +1155,7 @@ void ShopInfo::load(reader& inf)
         item.price = (unsigned) unmarshallShort(inf);
         items.push_back(item);
     }
+    search_generation = 0;
 }
 
 LevelStashes::LevelStashes()
@@ -1718,6 +1755,7 @@ void StashTracker::search_stashes()
 
     update_corpses();
     update_identification();
+    update_search_generation();
 
     stash_search_reader reader(buf, sizeof buf);
 
@@ -2214,6 +2252,21 @@ void StashTracker::update_identification()
         entry.second._update_identification();
 }
 
+void StashTracker::update_search_generation()
+{
+    bool changed = searched_options != Options.generation;
+    for (int i = 0; i < NUM_OBJECT_CLASSES && !changed; ++i)
+        for (int j = 0; j < MAX_SUBTYPES && !changed; ++j)
+            changed = searched_type_ids[i][j] != you.type_ids[i][j];
+
+    if (!changed)
+        return;
+
+    searched_type_ids = you.type_ids;
+    searched_options = Options.generation;
+    ++text_generation;
+}
+
 //////////////////////////////////////////////
 
 ST_ItemIterator::ST_ItemIterator()
@@ -18,6 +18,16 @@ class writer;
 class StashMenu;
 
 struct stash_search_result;
+
+// The text a stash search looks at for one item. Building it means naming
+// the item and calling into Lua, so it's kept between searches.
+struct stash_search_text
+{
+    string name;        // What to show for a match.
+    string annotated;   // Annotations followed by the name.
+    string desc;        // Longer description, matched separately.
+};
+
 class Stash
 {
 public:
@@ -84,6 +94,7 @@ private:
     void _update_corpses(int rot_time);
     void _update_identification();
     void add_item(const item_def &item, bool add_to_front = false);
+    const vector<stash_search_text> &searchable_text() const;
 
 private:
     bool verified;      // Is this correct to the best of our knowledge?
@@ -95,6 +106,11 @@ private:
 
     vector<item_def> items;
 
+    // Search text for each item, valid while search_generation matches
+    // StashTracker::search_generation().
+    mutable vector<stash_search_text> search_cache;
+    mutable unsigned int search_generation;
+
     static bool are_items_same(const item_def &, const item_def &,
                                bool exact = false);
 
@@ -123,7 +139,7 @@ public:
 
     void write(FILE *f, bool identify = false) const;
 
-    void reset() { items.clear(); visited = true; }
+    void reset() { items.clear(); visited = true; search_generation = 0; }
     void set_name(const string& s) { name = s; }
 
     void add_item(const item_def &item, unsigned price);
@@ -152,6 +168,10 @@ private:
 
     vector<shop_item> items;
 
+    mutable vector<stash_search_text> search_cache;
+    mutable unsigned int search_generation;
+
+    const vector<stash_search_text> &searchable_text() const;
     string shop_item_name(const shop_item &si) const;
     string shop_item_desc(const shop_item &si) const;
     void describe_shop_item(const shop_item &si) const;
@@ -303,8 +323,10 @@ public:
 class StashTracker
 {
 public:
-    StashTracker() : levels(), last_corpse_update(0)
+    StashTracker() : levels(), last_corpse_update(0), text_generation(1),
+                     searched_options(0)
     {
+        searched_type_ids.init(false);
     }
 
     void search_stashes();
@@ -349,7 +371,12 @@ public:
     void dump(const char *filename, bool identify = false) const;
 
     void remove_shop(const level_pos &pos);
+
+    // Changes whenever item names might have changed across the board,
+    // making every stash's saved search text stale.
+    unsigned int search_generation() const { return text_generation; }
 private:
+    void update_search_generation();
     void get_matching_stashes(const base_pattern &search,
                               vector<stash_search_result> &results,
                               bool curr_lev = false) const;
@@ -366,6 +393,12 @@ private:
 
     int last_corpse_update;
 
+    // What item names were last searched under: identified item types and
+    // options (which include the Lua annotation hooks).
+    unsigned int text_generation;
+    id_arr searched_type_ids;
+    unsigned int searched_options;
+
     friend class ST_ItemIterator;
 };
 
@@ -11,7 +11,7 @@
 #include <algorithm>
 
 #include "dlua.h"
-#include "libutil.h" // map_find
+#include "libutil.h"
 #include "monster.h"
 #include "stringutil.h"
 
@@ -1246,7 +1246,7 @@ CrawlHashTable::CrawlHashTable(const CrawlHashTable& other)
         return;
     }
 
-    hash_map = new hash_map_type(*(other.hash_map));
+    hash_map = new hash_storage(*(other.hash_map));
 }
 
 CrawlHashTable::~CrawlHashTable()
@@ -1271,7 +1271,7 @@ CrawlHashTable &CrawlHashTable::operator = (const CrawlHashTable &other)
         return *this;
     }
 
-    hash_map = new hash_map_type(*(other.hash_map));
+    hash_map = new hash_storage(*(other.hash_map));
 
     return *this;
 }
@@ -1289,8 +1289,9 @@ void CrawlHashTable::write(writer &th) const
 
     marshallUnsigned(th, size());
 
-    for (const auto &entry : *hash_map)
+    for (unsigned int idx : hash_map->order)
     {
+        const value_type &entry = hash_map->entries[idx];
         marshallString(th, entry.first);
         entry.second.write(th);
     }
@@ -1332,7 +1333,7 @@ void CrawlHashTable::read(reader &th)
 
 #ifdef DEBUG_PROPS
 static map<string, int> accesses;
-# define ACCESS(x) ++accesses[x]
+# define ACCESS(x) ++accesses[(x).to_string()]
 #else
 # define ACCESS(x)
 #endif
@@ -1340,14 +1341,33 @@ static map<string, int> accesses;
 //////////////////
 // Misc functions
 
-bool CrawlHashTable::exists(const string &key) const
+int CrawlHashTable::find_entry(const prop_key &key) const
+{
+    if (!hash_map)
+        return -1;
+
+    const vector<uint32_t> &hashes = hash_map->hashes;
+    for (unsigned int i = 0, size = hashes.size(); i < size; ++i)
+    {
+        if (hashes[i] != key.hash)
+            continue;
+
+        const string &k = hash_map->entries[i].first;
+        if (k.length() == key.len && !memcmp(k.data(), key.str, key.len))
+            return i;
+    }
+
+    return -1;
+}
+
+bool CrawlHashTable::exists(const prop_key &key) const
 {
     if (!hash_map)
         return false;
 
     ACCESS(key);
     ASSERT_VALIDITY();
-    return hash_map->find(key) != hash_map->end();
+    return find_entry(key) != -1;
 }
 
 void CrawlHashTable::assert_validity() const
@@ -1358,8 +1378,9 @@ void CrawlHashTable::assert_validity() const
 
     size_t actual_size = 0;
 
-    for (const auto &entry : *hash_map)
+    for (unsigned int idx : hash_map->order)
     {
+        const value_type &entry = hash_map->entries[idx];
         actual_size++;
 
         const string          &key = entry.first;
@@ -1416,35 +1437,57 @@ void CrawlHashTable::assert_validity() const
 ////////////////////////////////
 // Accessors to contained values
 
-CrawlStoreValue& CrawlHashTable::get_value(const string &key)
+CrawlStoreValue& CrawlHashTable::get_value(const prop_key &key)
 {
     ASSERT_VALIDITY();
     init_hash_map();
 
     ACCESS(key);
-    iterator i = hash_map->find(key);
+    const int found = find_entry(key);
+    if (found != -1)
+        return hash_map->entries[found].second;
 
-    if (i == hash_map->end())
+    unsigned int idx;
+    if (hash_map->free_entries.empty())
     {
-        (*hash_map)[key]     = CrawlStoreValue();
-        CrawlStoreValue &val = (*hash_map)[key];
-
-        return val;
+        idx = hash_map->entries.size();
+        hash_map->entries.emplace_back(key.to_string(), CrawlStoreValue());
+        hash_map->hashes.push_back(key.hash);
+    }
+    else
+    {
+        idx = hash_map->free_entries.back();
+        hash_map->free_entries.pop_back();
+        hash_map->entries[idx].first.assign(key.str, key.len);
+        hash_map->hashes[idx] = key.hash;
     }
 
-    return i->second;
+    value_type &entry = hash_map->entries[idx];
+    vector<unsigned int> &order = hash_map->order;
+    order.insert(lower_bound(order.begin(), order.end(), idx,
+                             [this, &entry](unsigned int a, unsigned int)
+                             {
+                                 return hash_map->entries[a].first
+                                        < entry.first;
+                             }),
+                 idx);
+
+    return entry.second;
 }
 
-const CrawlStoreValue& CrawlHashTable::get_value(const string &key) const
+const CrawlStoreValue& CrawlHashTable::get_value(const prop_key &key) const
 {
     ASSERTM(hash_map,
-            "trying to read non-existent property \"%s\"", key.c_str());
+            "trying to read non-existent property \"%s\"",
+            key.to_string().c_str());
     ASSERT_VALIDITY();
 
     ACCESS(key);
-    CrawlStoreValue *store = map_find(*hash_map, key);
+    const int found = find_entry(key);
 
-    ASSERTM(store, "trying to read non-existent property \"%s\"", key.c_str());
+    ASSERTM(found != -1, "trying to read non-existent property \"%s\"",
+            key.to_string().c_str());
+    const CrawlStoreValue *store = &hash_map->entries[found].second;
     ASSERT(store->type != SV_NONE);
     ASSERT(!(store->flags & SFLAG_UNSET));
 
@@ -1458,7 +1501,7 @@ unsigned int CrawlHashTable::size() const
     if (hash_map == nullptr)
         return 0;
 
-    return hash_map->size();
+    return hash_map->order.size();
 }
 
 bool CrawlHashTable::empty() const
@@ -1466,25 +1509,34 @@ bool CrawlHashTable::empty() const
     if (hash_map == nullptr)
         return true;
 
-    return hash_map->empty();
+    return hash_map->order.empty();
 }
 
-void CrawlHashTable::erase(const string key)
+void CrawlHashTable::erase(const prop_key &key)
 {
     ASSERT_VALIDITY();
     init_hash_map();
 
     ACCESS(key);
-    iterator i = hash_map->find(key);
+    const int found = find_entry(key);
 
-    if (i != hash_map->end())
+    if (found != -1)
     {
+        value_type &entry = hash_map->entries[found];
 #ifdef ASSERTS
-        CrawlStoreValue &val = i->second;
-        ASSERT(!(val.flags & SFLAG_NO_ERASE));
+        ASSERT(!(entry.second.flags & SFLAG_NO_ERASE));
 #endif
 
-        hash_map->erase(i);
+        vector<unsigned int> &order = hash_map->order;
+        order.erase(find(order.begin(), order.end(), (unsigned int)found));
+
+        // The slot is kept for reuse rather than removed, so that the
+        // other entries don't move.
+        entry.first.clear();
+        entry.second.~CrawlStoreValue();
+        new (&entry.second) CrawlStoreValue();
+        hash_map->hashes[found] = 0;
+        hash_map->free_entries.push_back(found);
     }
 }
 
@@ -1503,7 +1555,7 @@ CrawlHashTable::iterator CrawlHashTable::begin()
     ASSERT_VALIDITY();
     init_hash_map();
 
-    return hash_map->begin();
+    return iterator(hash_map, hash_map->order.data());
 }
 
 CrawlHashTable::iterator CrawlHashTable::end()
@@ -1511,7 +1563,8 @@ CrawlHashTable::iterator CrawlHashTable::end()
     ASSERT_VALIDITY();
     init_hash_map();
 
-    return hash_map->end();
+    return iterator(hash_map, hash_map->order.data()
+                              + hash_map->order.size());
 }
 
 CrawlHashTable::const_iterator CrawlHashTable::begin() const
@@ -1519,7 +1572,7 @@ CrawlHashTable::const_iterator CrawlHashTable::begin() const
     ASSERT(hash_map != nullptr);
     ASSERT_VALIDITY();
 
-    return hash_map->begin();
+    return const_iterator(hash_map, hash_map->order.data());
 }
 
 CrawlHashTable::const_iterator CrawlHashTable::end() const
@@ -1527,7 +1580,8 @@ CrawlHashTable::const_iterator CrawlHashTable::end() const
     ASSERT(hash_map != nullptr);
     ASSERT_VALIDITY();
 
-    return hash_map->end();
+    return const_iterator(hash_map, hash_map->order.data()
+                                    + hash_map->order.size());
 }
 
 void CrawlHashTable::init_hash_map()
@@ -1535,7 +1589,7 @@ void CrawlHashTable::init_hash_map()
     if (hash_map != nullptr)
         return;
 
-    hash_map = new hash_map_type();
+    hash_map = new hash_storage();
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -8,6 +8,7 @@
 #define STORE_H
 
 #include <climits>
+#include <deque>
 #include <map>
 #include <string>
 #include <vector>
@@ -243,6 +244,41 @@ protected:
     friend class CrawlVector;
 };
 
+// A hash table key, with its length and hash worked out once. The
+// constructors are constexpr, so for the string literals most callers pass
+// the compiler can fold the hash away; in any case no std::string is built
+// just to look a key up.
+class prop_key
+{
+public:
+    constexpr prop_key(const char *s)
+        : str(s), len(_length(s)), hash(_hash(s, _length(s)))
+    {
+    }
+    prop_key(const string &s)
+        : str(s.c_str()), len(s.length()), hash(_hash(s.c_str(), s.length()))
+    {
+    }
+
+    string to_string() const { return string(str, len); }
+
+    const char *str;
+    size_t len;
+    uint32_t hash;
+
+private:
+    static constexpr size_t _length(const char *s, size_t n = 0)
+    {
+        return s[n] ? _length(s, n + 1) : n;
+    }
+    // FNV-1a.
+    static constexpr uint32_t _hash(const char *s, size_t n,
+                                    uint32_t h = 2166136261U)
+    {
+        return n ? _hash(s + 1, n - 1, (h ^ (uint8_t)*s) * 16777619U) : h;
+    }
+};
+
 // By default a hash table's value data types are heterogeneous. To
 // make it homogeneous (which causes dynamic type checking) you have
 // to give a type to the hash table constructor; once it's been
@@ -255,16 +291,69 @@ public:
 
     ~CrawlHashTable();
 
-    typedef map<string, CrawlStoreValue>  hash_map_type;
-    typedef hash_map_type::iterator       iterator;
-    typedef hash_map_type::const_iterator const_iterator;
+    typedef pair<string, CrawlStoreValue> value_type;
+
+protected:
+    // Most tables hold a handful of keys, so rather than a tree they're
+    // kept flat and searched by hash. Entries live in a deque and are
+    // never moved, so references into the table stay valid as keys are
+    // added, like they did with a map; erased entries are reused.
+    // order lists the live entries sorted by key, which is the order
+    // they are iterated and saved in.
+    struct hash_storage
+    {
+        deque<value_type> entries;
+        vector<uint32_t>  hashes;
+        vector<unsigned int> order;
+        vector<unsigned int> free_entries;
+    };
+
+    template <class V, class S>
+    class iterator_base
+    {
+    public:
+        typedef forward_iterator_tag iterator_category;
+        typedef V value_type;
+        typedef ptrdiff_t difference_type;
+        typedef V* pointer;
+        typedef V& reference;
+
+        iterator_base(S *s, const unsigned int *p) : store(s), pos(p) { }
+
+        V &operator*() const  { return store->entries[*pos]; }
+        V *operator->() const { return &store->entries[*pos]; }
+        iterator_base &operator++() { ++pos; return *this; }
+        iterator_base operator++(int)
+        {
+            iterator_base old = *this;
+            ++pos;
+            return old;
+        }
+        bool operator==(const iterator_base &other) const
+        {
+            return pos == other.pos;
+        }
+        bool operator!=(const iterator_base &other) const
+        {
+            return pos != other.pos;
+        }
+
+    private:
+        S *store;
+        const unsigned int *pos;
+    };
+
+public:
+    typedef iterator_base<value_type, hash_storage> iterator;
+    typedef iterator_base<const value_type, const hash_storage> const_iterator;
 
 protected:
     // NOTE: Not using auto_ptr because making hash_map an auto_ptr
     // causes compile weirdness in externs.h
-    hash_map_type *hash_map;
+    hash_storage *hash_map;
 
     void init_hash_map();
+    int find_entry(const prop_key &key) const;
 
     friend class CrawlStoreValue;
 
@@ -274,18 +363,14 @@ public:
     void write(writer &) const;
     void read(reader &);
 
-    bool exists(const string &key) const;
+    bool exists(const prop_key &key) const;
     void assert_validity() const;
 
     // NOTE: If the const versions of get_value() or [] are given a
     // key which doesn't exist, they will assert.
-    const CrawlStoreValue& get_value(const string &key) const;
-    const CrawlStoreValue& get_value(const char *key) const
-    { return get_value(string(key)); }
-    const CrawlStoreValue& operator[] (const string &key) const
+    const CrawlStoreValue& get_value(const prop_key &key) const;
+    const CrawlStoreValue& operator[] (const prop_key &key) const
     { return get_value(key); }
-    const CrawlStoreValue& operator[] (const char *key) const
-    { return get_value(string(key)); }
 
     // NOTE: If get_value() or [] is given a key which doesn't exist
     // in the table, an unset/empty CrawlStoreValue will be created
@@ -294,20 +379,15 @@ public:
     // hash table has a type (rather than being heterogeneous)
     // then trying to assign a different type to the CrawlStoreValue
     // will assert.
-    CrawlStoreValue& get_value(const string &key);
-    CrawlStoreValue& get_value(const char *key)
-    { return get_value(string(key)); }
-    CrawlStoreValue& operator[] (const string &key)
+    CrawlStoreValue& get_value(const prop_key &key);
+    CrawlStoreValue& operator[] (const prop_key &key)
     { return get_value(key); }
-    CrawlStoreValue& operator[] (const char *key)
-    { return get_value(string(key)); }
 
     // std::map style interface
     unsigned int size() const;
     bool      empty() const;
 
-    void      erase(const string key);
-    void      erase(const char *key) { erase(string(key)); }
+    void      erase(const prop_key &key);
     void      clear();
 
     const_iterator begin() const;
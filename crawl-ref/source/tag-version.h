@@ -173,6 +173,8 @@ enum tag_minor_version
     TAG_MINOR_ID_STATES,           // turn item_type_id_state_type into a bool
     TAG_MINOR_MON_HD_INFO,         // store player-known monster HD info
     TAG_MINOR_NO_LEVEL_FLAGS,      // remove a field of env
+    TAG_MINOR_BULK_GRIDS,          // Run-length encode level grids and map knowledge
+    TAG_MINOR_TRAVEL_TARGETS,      // Save stair distances to travel targets
 #endif
     NUM_TAG_MINORS,
     TAG_MINOR_VERSION = NUM_TAG_MINORS - 1
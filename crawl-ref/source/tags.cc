@@ -93,7 +93,8 @@ extern set<pair<string, level_id> > auto_unique_annotations;
 extern abyss_state abyssal_state;
 
 reader::reader(const string &_read_filename, int minorVersion)
-    : _filename(_read_filename), _chunk(0), _pbuf(nullptr), _read_offset(0),
+    : _filename(_read_filename), _chunk(0), _chunk_len(0), _chunk_pos(0),
+      _pbuf(nullptr), _mem(nullptr), _mem_len(0), _read_offset(0),
       _minorVersion(minorVersion), _safe_read(false)
 {
     _file       = fopen_u(_filename.c_str(), "rb");
@@ -101,11 +102,13 @@ reader::reader(const string &_read_filename, int minorVersion)
 }
 
 reader::reader(package *save, const string &chunkname, int minorVersion)
-    : _file(0), _chunk(0), opened_file(false), _pbuf(0), _read_offset(0),
-     _minorVersion(minorVersion), _safe_read(false)
+    : _file(0), _chunk(0), _chunk_len(0), _chunk_pos(0), opened_file(false),
+      _pbuf(0), _mem(nullptr), _mem_len(0), _read_offset(0),
+      _minorVersion(minorVersion), _safe_read(false)
 {
     ASSERT(save);
     _chunk = new chunk_reader(save, chunkname);
+    _chunk_buf.resize(READER_CHUNK_BUFFER);
 }
 
 reader::~reader()
@@ -124,6 +127,13 @@ void reader::close()
 
 void reader::advance(size_t offset)
 {
+    // Buffers can just skip ahead.
+    if (!_file && !_chunk)
+    {
+        read(nullptr, offset);
+        return;
+    }
+
     char junk[128];
 
     while (offset)
@@ -137,7 +147,7 @@ void reader::advance(size_t offset)
 bool reader::valid() const
 {
     return (_file && !feof(_file)) ||
-           (_pbuf && _read_offset < _pbuf->size());
+           (!_file && !_chunk && _read_offset < buf_size());
 }
 
 static NORETURN void _short_read(bool safe_read)
@@ -149,6 +159,16 @@ static NORETURN void _short_read(bool safe_read)
     die_noline("short read while reading save");
 }
 
+// Refill the read-ahead buffer from the chunk. Returns false at the end of
+// the chunk.
+bool reader::fill_chunk_buf()
+{
+    ASSERT(_chunk);
+    _chunk_pos = 0;
+    _chunk_len = _chunk->read(&_chunk_buf[0], _chunk_buf.size());
+    return _chunk_len > 0;
+}
+
 // Reads input in network byte order, from a file or buffer.
 unsigned char reader::readByte()
 {
@@ -161,16 +181,15 @@ unsigned char reader::readByte()
     }
     else if (_chunk)
     {
-        unsigned char buf;
-        if (_chunk->read(&buf, 1) != 1)
+        if (_chunk_pos >= _chunk_len && !fill_chunk_buf())
             _short_read(_safe_read);
-        return buf;
+        return _chunk_buf[_chunk_pos++];
     }
     else
     {
-        if (_read_offset >= _pbuf->size())
+        if (_read_offset >= buf_size())
             _short_read(_safe_read);
-        return (*_pbuf)[_read_offset++];
+        return buf_data()[_read_offset++];
     }
 }
 
@@ -188,15 +207,41 @@ void reader::read(void *data, size_t size)
     }
     else if (_chunk)
     {
-        if (_chunk->read(data, size) != size)
-            _short_read(_safe_read);
+        unsigned char *out = static_cast<unsigned char*>(data);
+
+        // Drain whatever was already read ahead.
+        const size_t buffered = min(size, _chunk_len - _chunk_pos);
+        if (buffered)
+        {
+            memcpy(out, &_chunk_buf[_chunk_pos], buffered);
+            _chunk_pos += buffered;
+            out += buffered;
+            size -= buffered;
+            if (!size)
+                return;
+        }
+
+        // Large reads go straight to the chunk, small ones refill the
+        // buffer first.
+        if (size >= _chunk_buf.size())
+        {
+            if (_chunk->read(out, size) != size)
+                _short_read(_safe_read);
+        }
+        else
+        {
+            if (!fill_chunk_buf() || _chunk_len < size)
+                _short_read(_safe_read);
+            memcpy(out, &_chunk_buf[0], size);
+            _chunk_pos = size;
+        }
     }
     else
     {
-        if (_read_offset+size > _pbuf->size())
+        if (_read_offset+size > buf_size())
             _short_read(_safe_read);
         if (data && size)
-            memcpy(data, &(*_pbuf)[_read_offset], size);
+            memcpy(data, buf_data() + _read_offset, size);
 
         _read_offset += size;
     }
@@ -216,9 +261,9 @@ void reader::setMinorVersion(int minorVersion)
 void reader::fail_if_not_eof(const string &name)
 {
     char dummy;
-    if (_chunk ? _chunk->read(&dummy, 1) :
+    if (_chunk ? _chunk_pos < _chunk_len || _chunk->read(&dummy, 1) :
         _file ? (fgetc(_file) != EOF) :
-        _read_offset >= _pbuf->size())
+        _read_offset >= buf_size())
     {
         fail("Incomplete read of \"%s\" - aborting.", name.c_str());
     }
@@ -234,13 +279,36 @@ void writer::check_ok(bool ok)
     }
 }
 
+writer::~writer()
+{
+    if (_chunk)
+    {
+        flush_chunk();
+        delete _chunk;
+    }
+}
+
+// Hand everything staged so far to the chunk (and so to zlib) in one go.
+void writer::flush_chunk()
+{
+    if (!_chunk_buf.empty())
+    {
+        _chunk->write(&_chunk_buf[0], _chunk_buf.size());
+        _chunk_buf.clear();
+    }
+}
+
 void writer::writeByte(unsigned char ch)
 {
     if (failed)
         return;
 
     if (_chunk)
-        _chunk->write(&ch, 1);
+    {
+        if (_chunk_buf.size() >= WRITER_CHUNK_BUFFER)
+            flush_chunk();
+        _chunk_buf.push_back(ch);
+    }
     else if (_file)
         check_ok(fputc(ch, _file) != EOF);
     else
@@ -253,7 +321,15 @@ void writer::write(const void *data, size_t size)
         return;
 
     if (_chunk)
-        _chunk->write(data, size);
+    {
+        const unsigned char* cdata = static_cast<const unsigned char*>(data);
+        if (_chunk_buf.size() + size > WRITER_CHUNK_BUFFER)
+            flush_chunk();
+        if (size >= WRITER_CHUNK_BUFFER)
+            _chunk->write(data, size);
+        else
+            _chunk_buf.insert(_chunk_buf.end(), cdata, cdata + size);
+    }
     else if (_file)
         check_ok(fwrite(data, 1, size, _file) == size);
     else
@@ -325,6 +401,8 @@ static void marshallMonsterInfo (writer &, const monster_info &);
 static void unmarshallMonsterInfo (reader &, monster_info &mi);
 static void marshallMapCell (writer &, const map_cell &);
 static void unmarshallMapCell (reader &, map_cell& cell);
+static void marshallMapKnowledge (writer &, const MapKnowledge &);
+static void unmarshallMapKnowledge (reader &, MapKnowledge &);
 
 template<typename T, typename T_iter, typename T_marshal>
 static void marshall_iterator(writer &th, T_iter beg, T_iter end,
@@ -787,6 +865,46 @@ static void _run_length_decode(reader &th, unmarshall um, grid &g,
     }
 }
 
+// Bulk grid encoding: the grid is walked in memory order (x major), and
+// stored as a series of (run length, value) pairs. Unlike
+// _run_length_encode, runs aren't capped at 255 cells.
+template <typename marshall, typename grid>
+static void _marshall_grid_runs(writer &th, marshall m, const grid &g)
+{
+    const int end = GXM * GYM;
+    int offset = 0;
+    while (offset < end)
+    {
+        const auto value = g[offset / GYM][offset % GYM];
+        int run = 1;
+        while (offset + run < end
+               && g[(offset + run) / GYM][(offset + run) % GYM] == value)
+        {
+            ++run;
+        }
+
+        marshallUnsigned(th, run);
+        m(th, value);
+        offset += run;
+    }
+}
+
+template <typename unmarshall, typename grid>
+static void _unmarshall_grid_runs(reader &th, unmarshall um, grid &g)
+{
+    const int end = GXM * GYM;
+    int offset = 0;
+    while (offset < end)
+    {
+        const int run = unmarshallUnsigned(th);
+        const auto value = um(th);
+        ASSERT(run > 0 && offset + run <= end);
+
+        for (const int stop = offset + run; offset < stop; ++offset)
+            g[offset / GYM][offset % GYM] = value;
+    }
+}
+
 union float_marshall_kludge
 {
     // [ds] Does ANSI C guarantee that sizeof(float) == sizeof(long)?
@@ -3707,19 +3825,13 @@ static void tag_construct_level(writer &th)
 
     CANARY;
 
-    for (int count_x = 0; count_x < GXM; count_x++)
-        for (int count_y = 0; count_y < GYM; count_y++)
-        {
-            marshallByte(th, grd[count_x][count_y]);
-            marshallMapCell(th, env.map_knowledge[count_x][count_y]);
-            marshallInt(th, env.pgrid[count_x][count_y]);
-        }
+    _marshall_grid_runs(th, marshallUByte, grd);
+    marshallMapKnowledge(th, env.map_knowledge);
+    _marshall_grid_runs(th, marshallInt, env.pgrid);
 
     marshallBoolean(th, !!env.map_forgotten.get());
     if (env.map_forgotten.get())
-        for (int x = 0; x < GXM; x++)
-            for (int y = 0; y < GYM; y++)
-                marshallMapCell(th, (*env.map_forgotten)[x][y]);
+        marshallMapKnowledge(th, *env.map_forgotten);
 
     _run_length_encode(th, marshallByte, env.grid_colours, GXM, GYM);
 
@@ -4299,7 +4411,7 @@ void unmarshallItem(reader &th, item_def &item)
 #define MAP_SERIALIZE_CLOUD 0x20
 #define MAP_SERIALIZE_MONSTER 0x40
 
-void marshallMapCell(writer &th, const map_cell &cell)
+static unsigned _map_cell_serialize_flags(const map_cell &cell)
 {
     unsigned flags = 0;
 
@@ -4325,6 +4437,13 @@ void marshallMapCell(writer &th, const map_cell &cell)
     if (cell.monster() != MONS_NO_MONSTER)
         flags |= MAP_SERIALIZE_MONSTER;
 
+    return flags;
+}
+
+void marshallMapCell(writer &th, const map_cell &cell)
+{
+    const unsigned flags = _map_cell_serialize_flags(cell);
+
     marshallUnsigned(th, flags);
 
     switch (flags & MAP_SERIALIZE_FLAGS_MASK)
@@ -4370,6 +4489,39 @@ void marshallMapCell(writer &th, const map_cell &cell)
         marshallMonsterInfo(th, *cell.monsterinfo());
 }
 
+// Map knowledge is stored as alternating runs of blank cells, which take
+// no space beyond the run length, and of cells marshalled one by one.
+// Most of a level is usually either unexplored or fully explored, so this
+// keeps both the save and the loop over the grid small.
+void marshallMapKnowledge(writer &th, const MapKnowledge &mk)
+{
+    const int end = GXM * GYM;
+    int offset = 0;
+    while (offset < end)
+    {
+        int blank = 0;
+        while (offset + blank < end
+               && !_map_cell_serialize_flags(mk[(offset + blank) / GYM]
+                                               [(offset + blank) % GYM]))
+        {
+            ++blank;
+        }
+        marshallUnsigned(th, blank);
+        offset += blank;
+
+        int full = 0;
+        while (offset + full < end
+               && _map_cell_serialize_flags(mk[(offset + full) / GYM]
+                                              [(offset + full) % GYM]))
+        {
+            ++full;
+        }
+        marshallUnsigned(th, full);
+        for (const int stop = offset + full; offset < stop; ++offset)
+            marshallMapCell(th, mk[offset / GYM][offset % GYM]);
+    }
+}
+
 void unmarshallMapCell(reader &th, map_cell& cell)
 {
     unsigned flags = unmarshallUnsigned(th);
@@ -4467,6 +4619,25 @@ void unmarshallMapCell(reader &th, map_cell& cell)
     cell.flags = cell_flags;
 }
 
+void unmarshallMapKnowledge(reader &th, MapKnowledge &mk)
+{
+    const int end = GXM * GYM;
+    int offset = 0;
+    while (offset < end)
+    {
+        const int blank = unmarshallUnsigned(th);
+        ASSERT(offset + blank <= end);
+        for (const int stop = offset + blank; offset < stop; ++offset)
+            mk[offset / GYM][offset % GYM].clear();
+
+        const int full = unmarshallUnsigned(th);
+        ASSERT(blank || full);
+        ASSERT(offset + full <= end);
+        for (const int stop = offset + full; offset < stop; ++offset)
+            unmarshallMapCell(th, mk[offset / GYM][offset % GYM]);
+    }
+}
+
 static void tag_construct_level_items(writer &th)
 {
     // how many traps?
@@ -5075,12 +5246,30 @@ static void tag_read_level(reader &th)
 
     EAT_CANARY;
 
+#if TAG_MAJOR_VERSION == 34
+    if (th.getMinorVersion() < TAG_MINOR_BULK_GRIDS)
+    {
+        for (int i = 0; i < gx; i++)
+            for (int j = 0; j < gy; j++)
+            {
+                grd[i][j] = unmarshallFeatureType(th);
+                unmarshallMapCell(th, env.map_knowledge[i][j]);
+                env.pgrid[i][j] = unmarshallInt(th);
+            }
+    }
+    else
+#endif
+    {
+        _unmarshall_grid_runs(th, unmarshallFeatureType, grd);
+        unmarshallMapKnowledge(th, env.map_knowledge);
+        _unmarshall_grid_runs(th, unmarshallInt, env.pgrid);
+    }
+
     env.map_seen.reset();
     for (int i = 0; i < gx; i++)
         for (int j = 0; j < gy; j++)
         {
-            dungeon_feature_type feat = unmarshallFeatureType(th);
-            grd[i][j] = feat;
+            const dungeon_feature_type feat = grd[i][j];
             ASSERT(feat < NUM_FEATURES);
 #if TAG_MAJOR_VERSION == 34
             if (feat == DNGN_SEALED_DOOR && th.getMinorVersion() < TAG_MINOR_0_12)
@@ -5099,7 +5288,6 @@ static void tag_read_level(reader &th)
             }
 #endif
 
-            unmarshallMapCell(th, env.map_knowledge[i][j]);
             // Fixup positions
             if (env.map_knowledge[i][j].monsterinfo())
                 env.map_knowledge[i][j].monsterinfo()->pos = coord_def(i, j);
@@ -5109,7 +5297,6 @@ static void tag_read_level(reader &th)
             env.map_knowledge[i][j].flags &= ~MAP_VISIBLE_FLAG;
             if (env.map_knowledge[i][j].seen())
                 env.map_seen.set(i, j);
-            env.pgrid[i][j] = unmarshallInt(th);
 
             mgrd[i][j] = NON_MONSTER;
             env.cgrid[i][j] = EMPTY_CLOUD;
@@ -5124,9 +5311,16 @@ static void tag_read_level(reader &th)
     if (unmarshallBoolean(th))
     {
         MapKnowledge *f = new MapKnowledge();
-        for (int x = 0; x < GXM; x++)
-            for (int y = 0; y < GYM; y++)
-                unmarshallMapCell(th, (*f)[x][y]);
+#if TAG_MAJOR_VERSION == 34
+        if (th.getMinorVersion() < TAG_MINOR_BULK_GRIDS)
+        {
+            for (int x = 0; x < GXM; x++)
+                for (int y = 0; y < GYM; y++)
+                    unmarshallMapCell(th, (*f)[x][y]);
+        }
+        else
+#endif
+        unmarshallMapKnowledge(th, *f);
         env.map_forgotten.reset(f);
     }
     else
@@ -5767,6 +5961,8 @@ static void tag_read_level_monsters(reader &th)
     {
         monster& m = menv[i];
         unmarshallMonster(th, m);
+        if (m.type != MONS_NO_MONSTER)
+            mons_slot_used(&m);
 
         // place monster
         if (!m.alive())
@@ -50,9 +50,10 @@ public:
     {
         ASSERT(save);
         _chunk = save->writer(chunkname);
+        _chunk_buf.reserve(WRITER_CHUNK_BUFFER);
     }
 
-    ~writer() { if (_chunk) delete _chunk; }
+    ~writer();
 
     void writeByte(unsigned char byte);
     void write(const void *data, size_t size);
@@ -62,11 +63,17 @@ public:
 
 private:
     void check_ok(bool ok);
+    void flush_chunk();
+
+    // Chunk output is staged here and handed to zlib in large blocks,
+    // rather than deflating every marshalled byte separately.
+    static const size_t WRITER_CHUNK_BUFFER = 16384;
 
 private:
     string _filename;
     FILE* _file;
     chunk_writer *_chunk;
+    vector<unsigned char> _chunk_buf;
     bool _ignore_errors;
 
     vector<unsigned char>* _pbuf;
@@ -98,12 +105,22 @@ class reader
 public:
     reader(const string &filename, int minorVersion = TAG_MINOR_INVALID);
     reader(FILE* input, int minorVersion = TAG_MINOR_INVALID)
-        : _file(input), _chunk(0), opened_file(false), _pbuf(0),
+        : _file(input), _chunk(0), _chunk_len(0), _chunk_pos(0),
+          opened_file(false), _pbuf(0), _mem(nullptr), _mem_len(0),
           _read_offset(0), _minorVersion(minorVersion), _safe_read(false) {}
     reader(const vector<unsigned char>& input,
            int minorVersion = TAG_MINOR_INVALID)
-        : _file(0), _chunk(0), opened_file(false), _pbuf(&input),
+        : _file(0), _chunk(0), _chunk_len(0), _chunk_pos(0),
+          opened_file(false), _pbuf(&input), _mem(nullptr), _mem_len(0),
           _read_offset(0), _minorVersion(minorVersion), _safe_read(false) {}
+    // Reads from memory owned by the caller, such as a mapped file.
+    reader(const char *input, size_t len,
+           int minorVersion = TAG_MINOR_INVALID)
+        : _file(0), _chunk(0), _chunk_len(0), _chunk_pos(0),
+          opened_file(false), _pbuf(0),
+          _mem(reinterpret_cast<const unsigned char *>(input)),
+          _mem_len(len), _read_offset(0), _minorVersion(minorVersion),
+          _safe_read(false) {}
     reader(package *save, const string &chunkname,
            int minorVersion = TAG_MINOR_INVALID);
     ~reader();
@@ -121,12 +138,29 @@ public:
 
     void set_safe_read(bool setting) { _safe_read = setting; }
 
+private:
+    bool fill_chunk_buf();
+    const unsigned char *buf_data() const
+    {
+        return _pbuf ? _pbuf->data() : _mem;
+    }
+    size_t buf_size() const { return _pbuf ? _pbuf->size() : _mem_len; }
+
+    // Decompressed chunk data is read ahead into this buffer, so that
+    // single-byte unmarshalling doesn't inflate() once per byte.
+    static const size_t READER_CHUNK_BUFFER = 16384;
+
 private:
     string _filename;
     FILE* _file;
     chunk_reader *_chunk;
+    vector<unsigned char> _chunk_buf;
+    size_t _chunk_len;
+    size_t _chunk_pos;
     bool  opened_file;
     const vector<unsigned char>* _pbuf;
+    const unsigned char *_mem;
+    size_t _mem_len;
     unsigned int _read_offset;
     int _minorVersion;
     // always throw an exception rather than dying when reading past EOF
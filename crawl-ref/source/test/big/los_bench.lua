@@ -0,0 +1,25 @@
+-- Times losight() over a handful of generated levels: LOS is computed
+-- from every non-solid cell of each level, the way monsters and the
+-- player need it each turn. Level generation is random, so compare
+-- totals over a few runs rather than single levels.
+--
+-- Run with: ./crawl -test big/los_bench
+
+local niters = 20
+local places = { "D:2", "D:12", "Lair:2", "Elf:2", "Depths:3", "Zot:3" }
+
+local function bench(place)
+  test.regenerate_level(place, true)
+
+  local start = crawl.millis()
+  local calls = debug.losight(niters)
+  local ms = crawl.millis() - start
+
+  crawl.stderr(string.format(
+    "%-8s losight: %6d ms for %7d calls (%.2f us/call)",
+    place, ms, calls, calls > 0 and ms * 1000 / calls or 0))
+end
+
+for _, place in ipairs(places) do
+  bench(place)
+end
@@ -0,0 +1,35 @@
+-- Times the level save path: marshalling a level into memory
+-- (tag_construct_level and friends), and a full save_level into a save
+-- package, including compression.
+--
+-- Run with: ./crawl -test big/save_level_bench
+
+local niters = 200
+local places = { "D:2", "Lair:2", "Elf:2", "Depths:3" }
+
+local function bench(place)
+  test.regenerate_level(place, true)
+
+  local start = crawl.millis()
+  local bytes = 0
+  for i = 1, niters do
+    bytes = debug.save_level(true)
+  end
+  local marshall_ms = crawl.millis() - start
+
+  start = crawl.millis()
+  local packed = 0
+  for i = 1, niters do
+    packed = debug.save_level()
+  end
+  local save_ms = crawl.millis() - start
+
+  crawl.stderr(string.format(
+    "%-8s marshall: %6d ms (%d bytes)  save: %6d ms (%d bytes packed)" ..
+    "  [%d iterations]",
+    place, marshall_ms, bytes, save_ms, packed, niters))
+end
+
+for _, place in ipairs(places) do
+  bench(place)
+end
@@ -60,6 +60,14 @@ static unsigned int get_milliseconds()
     return ((unsigned int) tv.tv_sec) * 1000 + tv.tv_usec / 1000;
 }
 
+// Once this much output is queued for a receiver that isn't keeping up,
+// wait for it to catch up before queueing more.
+static const size_t WEBTILES_MAX_QUEUED = 1024 * 1024;
+
+// While waiting for input with output still queued, wake up this often
+// (in microseconds) to try to send more of it.
+static const int WEBTILES_SEND_RETRY_USEC = 20 * 1000;
+
 TilesFramework tiles;
 
 TilesFramework::TilesFramework()
@@ -80,6 +88,10 @@ TilesFramework::TilesFramework()
     default_cell.tile.bg = TILE_FLAG_UNSEEN;
     m_next_view.init(default_cell);
     m_current_view.init(default_cell);
+
+    m_socket_stats.bytes = 0;
+    m_socket_stats.messages = 0;
+    m_socket_stats.stalls = 0;
 }
 
 TilesFramework::~TilesFramework()
@@ -88,6 +100,23 @@ TilesFramework::~TilesFramework()
 
 void TilesFramework::shutdown()
 {
+    // We may be crashing, so only pass on what the receivers will take
+    // right now: never wait for them, and never die() over an error.
+    for (const MessageDest &dest : m_dest_addrs)
+    {
+        size_t sent = dest.sent;
+        while (sent < m_out_buf.size())
+        {
+            const size_t fragment_size = min<size_t>(m_max_msg_size,
+                                                m_out_buf.size() - sent);
+            ssize_t retval = sendto(m_sock, m_out_buf.data() + sent,
+                fragment_size, MSG_DONTWAIT, (sockaddr*) &dest.addr,
+                sizeof(sockaddr_un));
+            if (retval <= 0)
+                break;
+            sent += retval;
+        }
+    }
     close(m_sock);
     remove(m_sock_name.c_str());
 }
@@ -142,20 +171,56 @@ string TilesFramework::get_message()
     return m_msg_buf;
 }
 
-void TilesFramework::write_message(const char *format, ...)
+// Format straight onto the end of buf, growing it as needed. This is
+// what write_message and send_message are built on, so there's no limit
+// on the size of a message.
+static void _append_vformat(string &buf, const char *format, va_list args)
 {
-    char buf[2048];
-    int len;
+    va_list args2;
+    va_copy(args2, args);
 
+    // Most pieces are short, so format them on the stack; only a piece
+    // too big for that is formatted again straight into buf.
+    char scratch[2048];
+    int len = vsnprintf(scratch, sizeof(scratch), format, args);
+    if (len < 0)
+        die("Webtiles message format error! (%s)", format);
+    if ((size_t) len < sizeof(scratch))
+        buf.append(scratch, len);
+    else
+    {
+        const size_t old_size = buf.size();
+        buf.resize(old_size + len + 1);
+        vsnprintf(&buf[old_size], len + 1, format, args2);
+        buf.resize(old_size + len);
+    }
+    va_end(args2);
+}
+
+// Append the decimal form of value, without going through printf.
+static void _append_int(string &buf, int value)
+{
+    char digits[12];
+    char *const end = digits + sizeof(digits);
+    char *p = end;
+    unsigned int u = value < 0 ? 0U - (unsigned int) value : value;
+    do
+    {
+        *--p = '0' + u % 10;
+        u /= 10;
+    }
+    while (u);
+    if (value < 0)
+        *--p = '-';
+    buf.append(p, end - p);
+}
+
+void TilesFramework::write_message(const char *format, ...)
+{
     va_list argp;
     va_start(argp, format);
-    if ((len = vsnprintf(buf, sizeof(buf), format, argp)) < 0)
-        die("Webtiles message format error! (%s)", format);
-    else if (len >= (int)sizeof(buf))
-        die("Webtiles message too long! (%d)", len);
+    _append_vformat(m_msg_buf, format, argp);
     va_end(argp);
-
-    m_msg_buf.append(buf);
 }
 
 void TilesFramework::finish_message()
@@ -164,82 +229,97 @@ void TilesFramework::finish_message()
         return;
 
     m_msg_buf.append("\n");
-    const char* fragment_start = m_msg_buf.data();
-    const char* data_end = m_msg_buf.data() + m_msg_buf.size();
-    while (fragment_start < data_end)
+    // Nobody is listening yet (or any more); drop it like sendto would.
+    if (!m_dest_addrs.empty())
     {
-        int fragment_size = data_end - fragment_start;
-        if (fragment_size > m_max_msg_size)
-            fragment_size = m_max_msg_size;
+        m_out_buf.append(m_msg_buf);
+        m_socket_stats.messages++;
+    }
+    m_msg_buf.clear();
+
+    if (m_out_buf.size() >= WEBTILES_MAX_QUEUED)
+        _send_queued(true);
+}
 
-        for (unsigned int i = 0; i < m_dest_addrs.size(); ++i)
+// Send as much of the queued output as the receivers will take. Unless
+// block is true, a receiver that isn't ready is left for a later call;
+// otherwise we wait for it (and give up on the whole game if a single
+// fragment stalls too long).
+// Returns whether everything queued has been sent.
+bool TilesFramework::_send_queued(bool block)
+{
+    for (unsigned int i = 0; i < m_dest_addrs.size(); ++i)
+    {
+        int retries = 30;
+        while (m_dest_addrs[i].sent < m_out_buf.size())
         {
-            int retries = 30;
-            ssize_t sent = 0;
-            while (sent < fragment_size)
+            MessageDest &dest = m_dest_addrs[i];
+            const size_t fragment_size = min<size_t>(m_max_msg_size,
+                                            m_out_buf.size() - dest.sent);
+            ssize_t retval = sendto(m_sock, m_out_buf.data() + dest.sent,
+                fragment_size, MSG_DONTWAIT, (sockaddr*) &dest.addr,
+                sizeof(sockaddr_un));
+            if (retval > 0)
             {
-                ssize_t retval = sendto(m_sock, fragment_start + sent,
-                    fragment_size - sent, 0, (sockaddr*) &m_dest_addrs[i],
-                    sizeof(sockaddr_un));
-                if (retval <= 0)
-                {
-                    const char *errmsg = retval == 0 ? "No bytes sent"
-                                                     : strerror(errno);
-                    if (--retries <= 0)
-                        die("Socket write error: %s", errmsg);
+                dest.sent += retval;
+                m_socket_stats.bytes += retval;
+                retries = 30;
+                continue;
+            }
 
-                    if (retval == 0 || errno == ENOBUFS || errno == EWOULDBLOCK
-                        || errno == EINTR || errno == EAGAIN)
-                    {
-                        // Wait for half a second at first (up to five), then
-                        // try again.
-                        usleep(retries <= 10 ? 5000 * 1000 : 500 * 1000);
-                    }
-                    else if (errno == ECONNREFUSED || errno == ENOENT)
-                    {
-                        // the other side is dead
-                        m_dest_addrs.erase(m_dest_addrs.begin() + i);
-                        i--;
-                        break;
-                    }
-                    else
-                        die("Socket write error: %s", errmsg);
-                }
-                else
-                    sent += retval;
+            const char *errmsg = retval == 0 ? "No bytes sent"
+                                             : strerror(errno);
+            if (retval == 0 || errno == ENOBUFS || errno == EWOULDBLOCK
+                || errno == EINTR || errno == EAGAIN)
+            {
+                m_socket_stats.stalls++;
+                if (!block)
+                    break;
+
+                if (--retries <= 0)
+                    die("Socket write error: %s", errmsg);
+
+                // Wait for half a second at first (up to five), then
+                // try again.
+                usleep(retries <= 10 ? 5000 * 1000 : 500 * 1000);
             }
+            else if (errno == ECONNREFUSED || errno == ENOENT)
+            {
+                // the other side is dead
+                m_dest_addrs.erase(m_dest_addrs.begin() + i);
+                i--;
+                break;
+            }
+            else
+                die("Socket write error: %s", errmsg);
         }
-
-        fragment_start += fragment_size;
     }
-    m_msg_buf.clear();
+
+    // Drop whatever every receiver has been sent.
+    size_t done = m_out_buf.size();
+    for (const MessageDest &dest : m_dest_addrs)
+        done = min(done, dest.sent);
+    m_out_buf.erase(0, done);
+    for (MessageDest &dest : m_dest_addrs)
+        dest.sent -= done;
+
+    return m_out_buf.empty();
 }
 
 void TilesFramework::send_message(const char *format, ...)
 {
-    char buf[2048];
-    int len;
-
     va_list argp;
     va_start(argp, format);
-    if ((len = vsnprintf(buf, sizeof(buf), format, argp)) >= (int)sizeof(buf)
-        || len == -1)
-    {
-        if (len == -1)
-            die("Webtiles message format error! (%s)", format);
-        else
-            die("Webtiles message too long! (%d)", len);
-    }
+    _append_vformat(m_msg_buf, format, argp);
     va_end(argp);
 
-    m_msg_buf.append(buf);
-
     finish_message();
 }
 
 void TilesFramework::flush_messages()
 {
     send_message("*{\"msg\":\"flush_messages\"}");
+    _send_queued(false);
 }
 
 void TilesFramework::_await_connection()
@@ -291,7 +371,11 @@ wint_t TilesFramework::_handle_control_message(sockaddr_un addr, string data)
         JsonWrapper primary = json_find_member(obj.node, "primary");
         primary.check(JSON_BOOL);
 
-        m_dest_addrs.push_back(addr);
+        // Start the new receiver after whatever is queued for the others.
+        MessageDest dest;
+        dest.addr = addr;
+        dest.sent = m_out_buf.size();
+        m_dest_addrs.push_back(dest);
         m_controlled_from_web = primary->bool_;
     }
     else if (msgtype == "key")
@@ -346,6 +430,7 @@ bool TilesFramework::await_input(wint_t& c, bool block)
     int result;
     fd_set fds;
     int maxfd = m_sock;
+    bool retry_send = false;
 
     while (true)
     {
@@ -357,8 +442,19 @@ bool TilesFramework::await_input(wint_t& c, bool block)
 
             if (block)
             {
-                tiles.flush_messages();
-                result = select(maxfd + 1, &fds, nullptr, nullptr, nullptr);
+                if (retry_send)
+                    _send_queued(false);
+                else
+                    tiles.flush_messages();
+
+                // If a receiver is lagging behind, wake up every so often
+                // to send it more, rather than blocking the game on it.
+                timeval timeout;
+                timeout.tv_sec = 0;
+                timeout.tv_usec = WEBTILES_SEND_RETRY_USEC;
+
+                result = select(maxfd + 1, &fds, nullptr, nullptr,
+                                m_out_buf.empty() ? nullptr : &timeout);
             }
             else
             {
@@ -371,6 +467,10 @@ bool TilesFramework::await_input(wint_t& c, bool block)
         }
         while (result == -1 && errno == EINTR);
 
+        retry_send = block && result == 0;
+        if (retry_send)
+            continue;
+
         if (result == 0)
             return false;
         else if (result > 0)
@@ -404,6 +504,10 @@ bool TilesFramework::await_input(wint_t& c, bool block)
 void TilesFramework::dump()
 {
     fprintf(stderr, "Webtiles message buffer: %s\n", m_msg_buf.c_str());
+    fprintf(stderr, "Webtiles output: %" PRIu64 " messages queued, "
+            "%" PRIu64 " bytes sent, %u bytes pending, %" PRIu64 " stalls\n",
+            m_socket_stats.messages, m_socket_stats.bytes,
+            (unsigned int)m_out_buf.size(), m_socket_stats.stalls);
     fprintf(stderr, "Webtiles JSON stack:\n");
     for (const JsonFrame &frame : m_json_stack)
     {
@@ -534,7 +638,7 @@ void TilesFramework::update_input_mode(mouse_mode mode)
 
 static bool _update_string(bool force, string& current,
                            const string& next,
-                           const string& name,
+                           const char *name,
                            bool update = true)
 {
     if (force || current != next)
@@ -549,7 +653,7 @@ static bool _update_string(bool force, string& current,
 }
 
 template<class T> static bool _update_int(bool force, T& current, T next,
-                                          const string& name,
+                                          const char *name,
                                           bool update = true)
 {
     if (force || current != next)
@@ -792,7 +896,7 @@ void TilesFramework::_send_player(bool force_full)
     for (unsigned int i = 0; i < NUM_EQUIP; ++i)
     {
         const int8_t equip = !you.melded[i] ? you.equip[i] : -1;
-        _update_int(force_full, c.equip[i], equip, to_string(i));
+        _update_int(force_full, c.equip[i], equip, to_string(i).c_str());
     }
     json_close_object(true);
 
@@ -954,8 +1058,10 @@ static void _send_doll(const dolls_data &doll, bool submerged, bool ghost)
             ymax = 18;
         }
 
-        tiles.json_write_comma();
-        tiles.write_message("[%u,%d]", (unsigned int) doll.parts[p], ymax);
+        tiles.json_open_array();
+        tiles.json_write_int((int) doll.parts[p]);
+        tiles.json_write_int(ymax);
+        tiles.json_close_array();
     }
     tiles.json_close_array();
 }
@@ -974,8 +1080,8 @@ static void _send_mcache(mcache_entry *entry, bool submerged,
             _send_doll(*doll, submerged, trans);
         else
         {
-            tiles.json_write_comma();
-            tiles.write_message("\"doll\":[]");
+            tiles.json_open_array("doll");
+            tiles.json_close_array();
         }
     }
 
@@ -985,9 +1091,11 @@ static void _send_mcache(mcache_entry *entry, bool submerged,
     int draw_info_count = entry->info(&dinfo[0]);
     for (int i = 0; i < draw_info_count; i++)
     {
-        tiles.json_write_comma();
-        tiles.write_message("[%u,%d,%d]", (unsigned int) dinfo[i].idx,
-                            dinfo[i].ofs_x, dinfo[i].ofs_y);
+        tiles.json_open_array();
+        tiles.json_write_int((int) dinfo[i].idx);
+        tiles.json_write_int(dinfo[i].ofs_x);
+        tiles.json_write_int(dinfo[i].ofs_y);
+        tiles.json_close_array();
     }
 
     tiles.json_close_array();
@@ -1030,9 +1138,14 @@ static inline void _write_tileidx(tileidx_t t)
     const int lo = t & 0xFFFFFFFF;
     const int hi = t >> 32;
     if (hi == 0)
-        tiles.write_message("%d", lo);
+        tiles.json_write_int(lo);
     else
-        tiles.write_message("[%d,%d]", lo, hi);
+    {
+        tiles.json_open_array();
+        tiles.json_write_int(lo);
+        tiles.json_write_int(hi);
+        tiles.json_close_array();
+    }
 }
 
 void TilesFramework::_send_cell(const coord_def &gc,
@@ -1171,8 +1284,12 @@ void TilesFramework::_send_cell(const coord_def &gc,
                     _send_mcache(entry, in_water);
                 else
                 {
-                    json_write_comma();
-                    write_message("\"doll\":[[%d,%d]]", TILEP_MONS_UNKNOWN, TILE_Y);
+                    json_open_array("doll");
+                    json_open_array();
+                    json_write_int(TILEP_MONS_UNKNOWN);
+                    json_write_int(TILE_Y);
+                    json_close_array();
+                    json_close_array();
                 }
             }
         }
@@ -1216,8 +1333,12 @@ void TilesFramework::_send_cell(const coord_def &gc,
         {
             if (fg_changed)
             {
-                json_write_comma();
-                write_message("\"doll\":[[%u,%d]]", (unsigned int) fg_idx, TILE_Y);
+                json_open_array("doll");
+                json_open_array();
+                json_write_int((int) fg_idx);
+                json_write_int(TILE_Y);
+                json_close_array();
+                json_close_array();
             }
         }
 
@@ -1266,22 +1387,23 @@ void TilesFramework::_mcache_ref(bool inc)
 {
     for (int y = 0; y < GYM; y++)
         for (int x = 0; x < GXM; x++)
-        {
-            coord_def gc(x, y);
+            _mcache_ref(coord_def(x, y), inc);
+}
 
-            int fg_idx = m_current_view(gc).tile.fg & TILE_FLAG_MASK;
-            if (fg_idx >= TILEP_MCACHE_START)
-            {
-                mcache_entry *entry = mcache.get(fg_idx);
-                if (entry)
-                {
-                    if (inc)
-                        entry->inc_ref();
-                    else
-                        entry->dec_ref();
-                }
-            }
+void TilesFramework::_mcache_ref(const coord_def &gc, bool inc)
+{
+    int fg_idx = m_current_view(gc).tile.fg & TILE_FLAG_MASK;
+    if (fg_idx >= TILEP_MCACHE_START)
+    {
+        mcache_entry *entry = mcache.get(fg_idx);
+        if (entry)
+        {
+            if (inc)
+                entry->inc_ref();
+            else
+                entry->dec_ref();
         }
+    }
 }
 
 void TilesFramework::_send_map(bool force_full)
@@ -1324,56 +1446,71 @@ void TilesFramework::_send_map(bool force_full)
     coord_def last_gc(0, 0);
     bool send_gc = true;
 
+    // Visit cells in row order: the client relies on that to work out the
+    // position of cells sent without explicit coordinates. Cells marked
+    // dirty while we're sending go into a fresh list for the next send.
+    vector<coord_def> cells;
+    cells.swap(m_dirty_cell_list);
+    if (force_full)
+    {
+        cells.clear();
+        for (int y = 0; y < GYM; y++)
+            for (int x = 0; x < GXM; x++)
+                cells.emplace_back(x, y);
+    }
+    else
+    {
+        sort(cells.begin(), cells.end(),
+             [](const coord_def &a, const coord_def &b)
+             {
+                 return a.y < b.y || a.y == b.y && a.x < b.x;
+             });
+    }
+
     json_open_array("cells");
-    for (int y = 0; y < GYM; y++)
-        for (int x = 0; x < GXM; x++)
+    for (const coord_def &gc : cells)
+    {
+        if (cell_needs_redraw(gc))
         {
-            coord_def gc(x, y);
-
-            if (!is_dirty(gc) && !force_full)
-                continue;
-
-            if (cell_needs_redraw(gc))
-            {
-                screen_cell_t *cell = &m_next_view(gc);
+            screen_cell_t *cell = &m_next_view(gc);
 
-                draw_cell(cell, gc, false, m_current_flash_colour);
-                cell->tile.flv = env.tile_flv(gc);
-                pack_cell_overlays(gc, &(cell->tile));
-            }
+            draw_cell(cell, gc, false, m_current_flash_colour);
+            cell->tile.flv = env.tile_flv(gc);
+            pack_cell_overlays(gc, &(cell->tile));
+        }
 
-            mark_clean(gc);
+        mark_clean(gc);
 
-            if (m_origin.equals(-1, -1))
-                m_origin = gc;
+        if (m_origin.equals(-1, -1))
+            m_origin = gc;
 
-            json_open_object();
-            if (send_gc
-                || last_gc.x + 1 != gc.x
-                || last_gc.y != gc.y)
-            {
-                json_write_int("x", x - m_origin.x);
-                json_write_int("y", y - m_origin.y);
-                json_treat_as_empty();
-            }
+        json_open_object();
+        if (send_gc
+            || last_gc.x + 1 != gc.x
+            || last_gc.y != gc.y)
+        {
+            json_write_int("x", gc.x - m_origin.x);
+            json_write_int("y", gc.y - m_origin.y);
+            json_treat_as_empty();
+        }
 
-            const screen_cell_t& sc = force_full ? default_cell
-                : m_current_view(gc);
-            const map_cell& mc = force_full ? default_map_cell
-                : m_current_map_knowledge(gc);
-            _send_cell(gc,
-                       sc,
-                       m_next_view(gc),
-                       mc, env.map_knowledge(gc),
-                       new_monster_locs, force_full);
-
-            if (!json_is_empty())
-            {
-                send_gc = false;
-                last_gc = gc;
-            }
-            json_close_object(true);
+        const screen_cell_t& sc = force_full ? default_cell
+            : m_current_view(gc);
+        const map_cell& mc = force_full ? default_map_cell
+            : m_current_map_knowledge(gc);
+        _send_cell(gc,
+                   sc,
+                   m_next_view(gc),
+                   mc, env.map_knowledge(gc),
+                   new_monster_locs, force_full);
+
+        if (!json_is_empty())
+        {
+            send_gc = false;
+            last_gc = gc;
         }
+        json_close_object(true);
+    }
     json_close_array(true);
 
     json_close_object(true);
@@ -1383,13 +1520,29 @@ void TilesFramework::_send_map(bool force_full)
     if (force_full)
         _send_cursor(CURSOR_MAP);
 
-    if (m_mcache_ref_done)
-        _mcache_ref(false);
+    if (force_full || !m_mcache_ref_done)
+    {
+        if (m_mcache_ref_done)
+            _mcache_ref(false);
 
-    m_current_map_knowledge = env.map_knowledge;
-    m_current_view = m_next_view;
+        m_current_map_knowledge = env.map_knowledge;
+        m_current_view = m_next_view;
 
-    _mcache_ref(true);
+        _mcache_ref(true);
+    }
+    else
+    {
+        // Only the cells just sent can differ from what the client has,
+        // so there is no need to copy (and deep-copy the monster, item
+        // and cloud info of) the rest of the map.
+        for (const coord_def &gc : cells)
+        {
+            _mcache_ref(gc, false);
+            m_current_map_knowledge(gc) = env.map_knowledge(gc);
+            m_current_view(gc) = m_next_view(gc);
+            _mcache_ref(gc, true);
+        }
+    }
     m_mcache_ref_done = true;
 
     m_monster_locs = new_monster_locs;
@@ -1502,7 +1655,8 @@ void TilesFramework::load_dungeon(const crawl_view_buffer &vbuf,
             cell->tile.flv = env.tile_flv(grid);
             pack_cell_overlays(grid, &(cell->tile));
 
-            mark_clean(grid); // Remove redraw flag
+            // Remove redraw flag
+            m_cells_needing_redraw[grid.y * GXM + grid.x] = false;
             mark_dirty(grid);
         }
 
@@ -1843,7 +1997,10 @@ void TilesFramework::mark_for_redraw(const coord_def& gc)
 
 void TilesFramework::mark_dirty(const coord_def& gc)
 {
+    if (m_dirty_cells[gc.y * GXM + gc.x])
+        return;
     m_dirty_cells[gc.y * GXM + gc.x] = true;
+    m_dirty_cell_list.push_back(gc);
 }
 
 void TilesFramework::mark_clean(const coord_def& gc)
@@ -1864,36 +2021,50 @@ bool TilesFramework::cell_needs_redraw(const coord_def& gc)
 
 void TilesFramework::write_message_escaped(const string& s)
 {
-    m_msg_buf.reserve(m_msg_buf.size() + s.size());
+    write_message_escaped(s.data(), s.size());
+}
 
-    for (unsigned char c : s)
+void TilesFramework::write_message_escaped(const char *s, size_t len)
+{
+    m_msg_buf.reserve(m_msg_buf.size() + len);
+
+    // Copy runs of characters that don't need escaping in one go.
+    const char *run = s;
+    const char *const end = s + len;
+    for (const char *p = s; p < end; ++p)
     {
+        const unsigned char c = *p;
+        if (c != '"' && c != '\\' && c >= 0x20)
+            continue;
+
+        m_msg_buf.append(run, p - run);
+        run = p + 1;
         if (c == '"')
-            m_msg_buf.append("\\\"");
+            m_msg_buf.append("\\\"", 2);
         else if (c == '\\')
-            m_msg_buf.append("\\\\");
-        else if (c < 0x20)
+            m_msg_buf.append("\\\\", 2);
+        else
         {
-            char buf[7];
-            snprintf(buf, sizeof(buf), "\\u%04x", c);
-            m_msg_buf.append(buf);
+            static const char hex[] = "0123456789abcdef";
+            m_msg_buf.append("\\u00", 4);
+            m_msg_buf.push_back(hex[c >> 4]);
+            m_msg_buf.push_back(hex[c & 0xf]);
         }
-        else
-            m_msg_buf.append(1, c);
     }
+    m_msg_buf.append(run, end - run);
 }
 
-void TilesFramework::json_open(const string& name, char opener, char type)
+void TilesFramework::json_open(const char *name, char opener, char type)
 {
     m_json_stack.resize(m_json_stack.size() + 1);
     JsonFrame& fr = m_json_stack.back();
     fr.start = m_msg_buf.size();
 
     json_write_comma();
-    if (!name.empty())
+    if (*name)
         json_write_name(name);
 
-    m_msg_buf.append(1, opener);
+    m_msg_buf.push_back(opener);
 
     fr.prefix_end = m_msg_buf.size();
     fr.type = type;
@@ -1935,21 +2106,31 @@ void TilesFramework::json_close(bool erase_if_empty, char type)
     m_json_stack.pop_back();
 }
 
-void TilesFramework::json_open_object(const string& name)
+void TilesFramework::json_open_object(const char *name)
 {
     json_open(name, '{', '}');
 }
 
+void TilesFramework::json_open_object(const string& name)
+{
+    json_open(name.c_str(), '{', '}');
+}
+
 void TilesFramework::json_close_object(bool erase_if_empty)
 {
     json_close(erase_if_empty, '}');
 }
 
-void TilesFramework::json_open_array(const string& name)
+void TilesFramework::json_open_array(const char *name)
 {
     json_open(name, '[', ']');
 }
 
+void TilesFramework::json_open_array(const string& name)
+{
+    json_open(name.c_str(), '[', ']');
+}
+
 void TilesFramework::json_close_array(bool erase_if_empty)
 {
     json_close(erase_if_empty, ']');
@@ -1960,83 +2141,129 @@ void TilesFramework::json_write_comma()
     if (m_msg_buf.empty()) return;
     char last = m_msg_buf[m_msg_buf.size() - 1];
     if (last == '{' || last == '[' || last == ',' || last == ':') return;
-    write_message(",");
+    m_msg_buf.push_back(',');
+}
+
+void TilesFramework::json_write_name(const char *name)
+{
+    json_write_comma();
+
+    m_msg_buf.push_back('"');
+    write_message_escaped(name, strlen(name));
+    m_msg_buf.append("\":", 2);
 }
 
 void TilesFramework::json_write_name(const string& name)
 {
     json_write_comma();
 
-    write_message("\"");
+    m_msg_buf.push_back('"');
     write_message_escaped(name);
-    write_message("\":");
+    m_msg_buf.append("\":", 2);
 }
 
 void TilesFramework::json_write_int(int value)
 {
     json_write_comma();
 
-    write_message("%d", value);
+    _append_int(m_msg_buf, value);
 }
 
-void TilesFramework::json_write_int(const string& name, int value)
+void TilesFramework::json_write_int(const char *name, int value)
 {
-    if (!name.empty())
+    if (*name)
         json_write_name(name);
 
     json_write_int(value);
 }
 
+void TilesFramework::json_write_int(const string& name, int value)
+{
+    json_write_int(name.c_str(), value);
+}
+
 void TilesFramework::json_write_bool(bool value)
 {
     json_write_comma();
 
     if (value)
-        write_message("true");
+        m_msg_buf.append("true", 4);
     else
-        write_message("false");
+        m_msg_buf.append("false", 5);
 }
 
-void TilesFramework::json_write_bool(const string& name, bool value)
+void TilesFramework::json_write_bool(const char *name, bool value)
 {
-    if (!name.empty())
+    if (*name)
         json_write_name(name);
 
     json_write_bool(value);
 }
 
+void TilesFramework::json_write_bool(const string& name, bool value)
+{
+    json_write_bool(name.c_str(), value);
+}
+
 void TilesFramework::json_write_null()
 {
     json_write_comma();
 
-    write_message("null");
+    m_msg_buf.append("null", 4);
 }
 
-void TilesFramework::json_write_null(const string& name)
+void TilesFramework::json_write_null(const char *name)
 {
-    if (!name.empty())
+    if (*name)
         json_write_name(name);
 
     json_write_null();
 }
 
+void TilesFramework::json_write_null(const string& name)
+{
+    json_write_null(name.c_str());
+}
+
+void TilesFramework::json_write_string(const char *value)
+{
+    json_write_comma();
+
+    m_msg_buf.push_back('"');
+    write_message_escaped(value, strlen(value));
+    m_msg_buf.push_back('"');
+}
+
 void TilesFramework::json_write_string(const string& value)
 {
     json_write_comma();
 
-    write_message("\"");
+    m_msg_buf.push_back('"');
     write_message_escaped(value);
-    write_message("\"");
+    m_msg_buf.push_back('"');
 }
 
-void TilesFramework::json_write_string(const string& name, const string& value)
+void TilesFramework::json_write_string(const char *name, const char *value)
 {
-    if (!name.empty())
+    if (*name)
         json_write_name(name);
 
     json_write_string(value);
 }
 
+void TilesFramework::json_write_string(const char *name, const string& value)
+{
+    if (*name)
+        json_write_name(name);
+
+    json_write_string(value);
+}
+
+void TilesFramework::json_write_string(const string& name, const string& value)
+{
+    json_write_string(name.c_str(), value);
+}
+
 bool is_tiles()
 {
     return tiles.is_controlled_from_web();
@@ -141,6 +141,15 @@ public:
     void send_message(PRINTF(1, ));
     void flush_messages();
 
+    // Counters for the output sent to the webtiles server.
+    struct SocketStats
+    {
+        uint64_t bytes;     // bytes handed to the socket
+        uint64_t messages;  // complete messages queued for sending
+        uint64_t stalls;    // times a receiver couldn't take more data
+    };
+    const SocketStats &socket_stats() const { return m_socket_stats; }
+
     bool has_receivers() { return !m_dest_addrs.empty(); }
     bool is_controlled_from_web() { return m_controlled_from_web; }
 
@@ -163,21 +172,33 @@ public:
 
     void check_for_control_messages();
 
-    // Helper functions for writing JSON
+    // Helper functions for writing JSON. These append straight to the
+    // message buffer, which keeps its capacity between messages; the
+    // const char* overloads save building a string for literal names.
     void write_message_escaped(const string& s);
-    void json_open_object(const string& name = "");
+    void write_message_escaped(const char *s, size_t len);
+    void json_open_object(const char *name = "");
+    void json_open_object(const string& name);
     void json_close_object(bool erase_if_empty = false);
-    void json_open_array(const string& name = "");
+    void json_open_array(const char *name = "");
+    void json_open_array(const string& name);
     void json_close_array(bool erase_if_empty = false);
     void json_write_comma();
+    void json_write_name(const char *name);
     void json_write_name(const string& name);
     void json_write_int(int value);
+    void json_write_int(const char *name, int value);
     void json_write_int(const string& name, int value);
     void json_write_bool(bool value);
+    void json_write_bool(const char *name, bool value);
     void json_write_bool(const string& name, bool value);
     void json_write_null();
+    void json_write_null(const char *name);
     void json_write_null(const string& name);
+    void json_write_string(const char *value);
     void json_write_string(const string& value);
+    void json_write_string(const char *name, const char *value);
+    void json_write_string(const char *name, const string& value);
     void json_write_string(const string& name, const string& value);
     /* Causes the current object/array to be erased if it is closed
        with erase_if_empty without writing any other content after
@@ -203,7 +224,21 @@ protected:
     int m_sock;
     int m_max_msg_size;
     string m_msg_buf;
-    vector<sockaddr_un> m_dest_addrs;
+
+    // Finished messages are queued here and sent in batches, without
+    // blocking, whenever messages are flushed.
+    string m_out_buf;
+    SocketStats m_socket_stats;
+
+    struct MessageDest
+    {
+        sockaddr_un addr;
+        // How much of m_out_buf this receiver has been sent already.
+        size_t sent;
+    };
+    vector<MessageDest> m_dest_addrs;
+
+    bool _send_queued(bool block);
 
     bool m_controlled_from_web;
 
@@ -219,7 +254,7 @@ protected:
     };
     vector<JsonFrame> m_json_stack;
 
-    void json_open(const string& name, char opener, char type);
+    void json_open(const char *name, char opener, char type);
     void json_close(bool erase_if_empty, char type);
 
     struct MenuInfo
@@ -249,6 +284,9 @@ protected:
     coord_def m_next_view_br;
 
     bitset<GXM * GYM> m_dirty_cells;
+    // Every cell set in m_dirty_cells, in no particular order, so that
+    // _send_map doesn't have to scan the whole map for them.
+    vector<coord_def> m_dirty_cell_list;
     bitset<GXM * GYM> m_cells_needing_redraw;
     void mark_dirty(const coord_def& gc);
     void mark_clean(const coord_def& gc);
@@ -287,6 +325,7 @@ protected:
 
     bool m_mcache_ref_done;
     void _mcache_ref(bool inc);
+    void _mcache_ref(const coord_def &gc, bool inc);
 
     void _send_cursor(cursor_type type);
     void _send_map(bool force_full = false);
@@ -2828,6 +2828,14 @@ static int _find_transtravel_stair(const level_id &cur,
 
 static bool _loadlev_populate_stair_distances(const level_pos &target)
 {
+    // Waypoints, and targets we've travelled to before, have their
+    // distances remembered from when the player was last on the level.
+    if (travel_cache.get_level_info(target.id)
+            .get_target_distances(target.pos, curr_stairs))
+    {
+        return true;
+    }
+
     level_excursion excursion;
     excursion.go_to(target.id);
     _populate_stair_distances(target);
@@ -2836,25 +2844,9 @@ static bool _loadlev_populate_stair_distances(const level_pos &target)
 
 static void _populate_stair_distances(const level_pos &target)
 {
-    // Populate travel_point_distance.
-    find_travel_pos(target.pos, nullptr, nullptr, nullptr);
-
     LevelInfo &li = travel_cache.get_level_info(target.id);
-    const vector<stair_info> &stairs = li.get_stairs();
-
-    curr_stairs.clear();
-    for (int i = 0, count = stairs.size(); i < count; ++i)
-    {
-        stair_info si = stairs[i];
-        si.distance = travel_point_distance[si.position.x][si.position.y];
-        if (!si.distance && target.pos != si.position
-            || si.distance < -1)
-        {
-            si.distance = -1;
-        }
-
-        curr_stairs.push_back(si);
-    }
+    li.update_target_distances(target.pos);
+    li.get_target_distances(target.pos, curr_stairs);
 }
 
 static bool _find_transtravel_square(const level_pos &target, bool verbose)
@@ -3287,9 +3279,64 @@ void LevelInfo::update()
     precompute_travel_safety_grid travel_safety_calc;
     update_stair_distances();
 
+    // The level may have changed, so work out the distances to our travel
+    // targets again. Only keep the waypoints and the current interlevel
+    // travel target, so the list doesn't grow without bound.
+    vector<coord_def> targets;
+    for (int i = 0; i < TRAVEL_WAYPOINT_COUNT; ++i)
+    {
+        const level_pos &wp = travel_cache.get_waypoint(i);
+        if (wp.id == id && in_bounds(wp.pos))
+            targets.push_back(wp.pos);
+    }
+    if (level_target.id == id && in_bounds(level_target.pos))
+        targets.push_back(level_target.pos);
+
+    target_distances.clear();
+    for (const coord_def &target : targets)
+        update_target_distances(target);
+
     update_daction_counters(this);
 }
 
+void LevelInfo::update_target_distances(const coord_def &target)
+{
+    // Populate travel_point_distance.
+    find_travel_pos(target, nullptr, nullptr, nullptr);
+
+    target_stair_distances &dists = target_distances[target];
+    dists.clear();
+    for (const stair_info &si : stairs)
+    {
+        int dist = travel_point_distance[si.position.x][si.position.y];
+        if (!dist && target != si.position || dist < -1)
+            dist = -1;
+        dists.emplace_back(si.position, dist);
+    }
+}
+
+bool LevelInfo::get_target_distances(const coord_def &target,
+                                     vector<stair_info> &result) const
+{
+    auto found = target_distances.find(target);
+    if (found == target_distances.end())
+        return false;
+
+    // The stair list may have changed since the distances were worked out.
+    const target_stair_distances &dists = found->second;
+    if (dists.size() != stairs.size())
+        return false;
+
+    result = stairs;
+    for (int i = 0, count = result.size(); i < count; ++i)
+    {
+        if (dists[i].first != result[i].position)
+            return false;
+        result[i].distance = dists[i].second;
+    }
+    return true;
+}
+
 void LevelInfo::set_distance_between_stairs(int a, int b, int dist)
 {
     // Note dist == 0 is illegal because we can't have two stairs on
@@ -3613,6 +3660,18 @@ void LevelInfo::save(writer& outf) const
     marshallByte(outf, NUM_DACTION_COUNTERS);
     for (int i = 0; i < NUM_DACTION_COUNTERS; i++)
         marshallShort(outf, daction_counters[i]);
+
+    marshallShort(outf, target_distances.size());
+    for (const auto &entry : target_distances)
+    {
+        marshallCoord(outf, entry.first);
+        marshallShort(outf, entry.second.size());
+        for (const auto &dist : entry.second)
+        {
+            marshallCoord(outf, dist.first);
+            marshallShort(outf, dist.second);
+        }
+    }
 }
 
 void LevelInfo::load(reader& inf, int minorVersion)
@@ -3648,6 +3707,27 @@ void LevelInfo::load(reader& inf, int minorVersion)
     ASSERT_RANGE(n_count, 0, NUM_DACTION_COUNTERS + 1);
     for (int i = 0; i < n_count; i++)
         daction_counters[i] = unmarshallShort(inf);
+
+    target_distances.clear();
+#if TAG_MAJOR_VERSION == 34
+    if (minorVersion >= TAG_MINOR_TRAVEL_TARGETS)
+    {
+#endif
+    const int target_count = unmarshallShort(inf);
+    for (int i = 0; i < target_count; ++i)
+    {
+        target_stair_distances &dists =
+            target_distances[unmarshallCoord(inf)];
+        const int dist_count = unmarshallShort(inf);
+        for (int j = 0; j < dist_count; ++j)
+        {
+            const coord_def pos = unmarshallCoord(inf);
+            dists.emplace_back(pos, unmarshallShort(inf));
+        }
+    }
+#if TAG_MAJOR_VERSION == 34
+    }
+#endif
 }
 
 void LevelInfo::fixup()
@@ -290,7 +290,8 @@ public:
 // Information on a level that interlevel travel needs.
 struct LevelInfo
 {
-    LevelInfo() : stairs(), excludes(), stair_distances(), id()
+    LevelInfo() : stairs(), excludes(), stair_distances(),
+                  target_distances(), id()
     {
         daction_counters.init(0);
     }
@@ -321,6 +322,17 @@ struct LevelInfo
     // or does not exist in our list of stairs, returns 0.
     int distance_between(const stair_info *s1, const stair_info *s2) const;
 
+    // Works out and remembers the travel distance from target to each
+    // stair. Must be called while this is the current level.
+    void update_target_distances(const coord_def &target);
+
+    // Fills in stairs with our stairs, their distance set to the remembered
+    // distance from target. Returns false if we don't have the distances
+    // for every stair, in which case the level has to be loaded to find
+    // them.
+    bool get_target_distances(const coord_def &target,
+                              vector<stair_info> &stairs) const;
+
     void update_excludes();
     void update();              // Update LevelInfo to be correct for the
                                 // current level.
@@ -357,6 +369,12 @@ private:
     exclude_set excludes;
 
     vector<short> stair_distances;  // Dist between stairs
+
+    // Dist from travel targets (waypoints and the like) to each stair,
+    // kept so that travel to them needn't load this level.
+    typedef vector<pair<coord_def, short> > target_stair_distances;
+    map<coord_def, target_stair_distances> target_distances;
+
     level_id id;
 
     friend class TravelCache;
@@ -82,7 +82,9 @@ class WebtilesSocketConnection(object):
             self.msg_buffer = None
 
             if self.message_callback:
-                self.message_callback(data)
+                # Crawl batches messages, so there may be several here.
+                for msg in data[:-1].split("\n"):
+                    self.message_callback(msg + "\n")
 
     def send_message(self, data):
         start = datetime.now()